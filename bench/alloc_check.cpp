@@ -0,0 +1,105 @@
+//checks that the simulator stops allocating once it is warmed up. operator new is
+//replaced by one that counts, and every scheduler runs a trace of identical bursts
+//that each drain before the next one arrives. the queues are as long as they will
+//ever get after the first burst so the second half of the trace must not allocate
+//at all. exits with 1 if any run did
+
+//example ./bench/alloc_check [bursts] [burstsize]
+
+#define IOSCHED_NO_MAIN
+#include "../iosched.cpp"
+
+#include <cstdlib>
+#include <new>
+
+static unsigned long long allocations = 0;
+
+void* operator new(std::size_t size) {
+    allocations++;
+    void* pointer = malloc(size ? size : 1);
+    if (pointer == nullptr) throw std::bad_alloc();
+    return pointer;
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* pointer) noexcept { free(pointer); }
+void operator delete[](void* pointer) noexcept { free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { free(pointer); }
+
+//replays the trace and remembers the allocation count when it hands out the first
+//request of the second half
+class CountingSource {
+private:
+    TraceArraySource source;
+    std::size_t read = 0;
+    std::size_t half;
+public:
+    unsigned long long at_half = 0;
+    explicit CountingSource(const std::vector<TraceEntry>& trace) : source(trace), half(trace.size() / 2) {}
+    bool next(TraceEntry& entry) {
+        if (read == half) at_half = allocations;
+        bool ok = source.next(entry);
+        if (ok) read++;
+        return ok;
+    }
+    bool failed() const { return source.failed(); }
+};
+
+struct NullSink {
+    void request(long long, long long, long long, long long) {}
+};
+
+int main(int argc, char* argv[]) {
+    int bursts = argc > 1 ? atoi(argv[1]) : 200;
+    int burst_size = argc > 2 ? atoi(argv[2]) : 512;
+    //every burst arrives at once on pseudo random tracks, FIFO needs about a third of
+    //the tracks per request so the period leaves it time to drain too
+    const int tracks = 1000;
+    std::vector<TraceEntry> trace;
+    std::uint32_t seed = 12345;
+    for (int burst = 0; burst < bursts; burst++) {
+        for (int i = 0; i < burst_size; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            TraceEntry entry;
+            entry.arrival_time = burst * burst_size * tracks;
+            entry.track = static_cast<int>((seed >> 8) % tracks);
+            entry.size = 1 + i % 8;
+            entry.write = i % 3 == 0;
+            entry.stream = i % 4;
+            trace.push_back(entry);
+        }
+    }
+    struct Config {
+        const char* name;
+        SimulationOptions options;
+    };
+    std::vector<Config> configs(3);
+    configs[0].name = "plain";
+    configs[1].name = "merge";
+    configs[1].options.merge_limit = 16;
+    configs[2].name = "percentiles";
+    configs[2].options.percentiles = SimulationOptions::PERCENTILES_TEXT;
+    int status = 0;
+    std::cout << trace.size() << " requests" << std::endl;
+    std::cout << "sched  config         first half  second half" << std::endl;
+    for (char letter : Schedulers::letters()) {
+        for (const Config& config : configs) {
+            CountingSource source(trace);
+            NullSink sink;
+            SimulationSummary summary;
+            unsigned long long start = allocations, end = 0;
+            Schedulers::with_scheduler(letter, [&](auto& scheduler) {
+                NoTelemetry telemetry;
+                bool ok = run_simulation(scheduler, source, sink, summary, config.options, telemetry);
+                end = allocations;
+                return ok;
+            });
+            unsigned long long steady = end - source.at_half;
+            std::cout << std::left << std::setw(7) << letter << std::setw(15) << config.name << std::right
+                      << std::setw(10) << source.at_half - start << std::setw(13) << steady
+                      << (steady == 0 ? "" : "   ALLOCATES") << std::endl;
+            if (steady != 0) status = 1;
+        }
+    }
+    return status;
+}
@@ -0,0 +1,61 @@
+#!/bin/bash
+
+# checks that a run resumed from a checkpoint prints exactly what the run that was
+# never interrupted prints. every scheduler runs a generated trace with a checkpoint
+# every few thousand events (-C0), then the run is resumed from the last one with its
+# output appended to a copy of the full output, which has to cut the copy back to
+# the checkpoint and come out the same. then a run with real checkpoints is killed
+# part way through and resumed the same way. exits with 1 if any output differs
+
+# example ./bench/checkpoint_check.sh ./iosched 200000
+
+PROG=${1:-./iosched}
+NUMIO=${2:-200000}
+SCHEDS=${SCHEDS:-"N S L C F D B"}
+PROFILE=${PROFILE:-profiles/hdd7200.profile}
+TMP=${TMPDIR:-/tmp}/checkpoint_check.$$
+
+[[ ! -x ${PROG} ]] && echo "program <$PROG> is not executable" && exit 1
+
+trap "rm -f ${TMP}.*" EXIT
+
+# busy enough that the queues are long when a checkpoint is taken, with reads and
+# writes from a few streams for the deadline and BFQ schedulers
+awk -v n=${NUMIO} 'BEGIN { srand(23); t = 0;
+    for (i = 0; i < n; i++) { t += int(rand() * 12); printf "%d %d 0 %d %d %d %d\n", t, int(rand() * 512), int(rand() * 64), 1 + int(rand() * 8), rand() < 0.3, int(rand() * 4) } }' > ${TMP}.in
+
+STATUS=0
+check() {
+    local name=$1
+    shift
+    rm -f ${TMP}.ckpt
+    ${PROG} "$@" -C0,${TMP}.ckpt ${TMP}.in > ${TMP}.full
+    cp ${TMP}.full ${TMP}.out
+    ${PROG} "$@" -R${TMP}.ckpt ${TMP}.in >> ${TMP}.out
+    if cmp -s ${TMP}.full ${TMP}.out; then
+        printf "%-24s ok\n" "${name}"
+    else
+        printf "%-24s DIFFERS\n" "${name}"
+        STATUS=1
+    fi
+}
+
+for s in ${SCHEDS}; do
+    check "-s${s}" -s${s}
+    check "-s${s} -Ptext" -s${s} -Ptext
+    check "-s${s} -M8" -s${s} -M8
+    check "-s${s} -Q16,rpo -p" -s${s} -Q16,rpo -p ${PROFILE}
+    check "-s${s} -l -q" -s${s} -l -q
+done
+
+# a run that really dies, if it got far enough to write a checkpoint
+${PROG} -sL ${TMP}.in > ${TMP}.full
+rm -f ${TMP}.ckpt
+timeout -s KILL 0.3 ${PROG} -sL -C0.05,${TMP}.ckpt ${TMP}.in > ${TMP}.out
+if [[ -f ${TMP}.ckpt ]]; then
+    ${PROG} -sL -R${TMP}.ckpt ${TMP}.in >> ${TMP}.out
+    cmp -s ${TMP}.full ${TMP}.out && printf "%-24s ok\n" "killed -sL" || { printf "%-24s DIFFERS\n" "killed -sL"; STATUS=1; }
+else
+    printf "%-24s finished before a checkpoint\n" "killed -sL"
+fi
+exit ${STATUS}
@@ -0,0 +1,33 @@
+#!/bin/bash
+
+# shows that the simulator runtime follows the number of requests and not the
+# simulated time. the same request pattern is replayed with arrival gaps and
+# track numbers stretched by growing factors, so total_time and total_movement
+# grow with the scale while the request count stays the same.
+
+# example ./bench/idle_gap.sh ./iosched 10000
+
+PROG=${1:-./iosched}
+NUMIO=${2:-10000}
+SCALES=${SCALES:-"1 10 100 1000"}
+SCHEDS=${SCHEDS:-"N S L C F"}
+TMP=${TMPDIR:-/tmp}/idle_gap.$$
+
+[[ ! -x ${PROG} ]] && echo "program <$PROG> is not executable" && exit 1
+
+trap "rm -f ${TMP}.*" EXIT
+
+now() { date +%s.%N; }
+
+printf "%-8s %-6s %12s %14s %9s\n" "scale" "sched" "total_time" "total_movement" "seconds"
+for x in ${SCALES}; do
+    # arrivals roughly every 10 units on 256 tracks before scaling
+    awk -v n=${NUMIO} -v x=${x} 'BEGIN { srand(17); t = 0;
+        for (i = 0; i < n; i++) { t += 1 + int(rand() * 20); printf "%d %d\n", t * x, int(rand() * 256) * x } }' > ${TMP}.in
+    for s in ${SCHEDS}; do
+        START=$(now)
+        SUM=$(${PROG} -s${s} ${TMP}.in | tail -1)
+        END=$(now)
+        echo "${x} ${s} ${SUM} ${START} ${END}" | awk '{ printf "%-8s %-6s %12s %14s %9.3f\n", $1, $2, $4, $5, $NF - $(NF-1) }'
+    done
+done
@@ -0,0 +1,66 @@
+//writes a synthetic trace in the input file format to stdout, see trace_gen.h
+
+//example ./bench/iogen -n 500 -m 512 -l 0.02 -d zipf -z 1.2 > trace.in
+
+#define IOSCHED_NO_MAIN
+#include "../iosched.cpp"
+#include "trace_gen.h"
+
+int main(int argc, char* argv[]) {
+    TraceGenerator::Params params;
+    const char* usage = "Usage: ./bench/iogen [-n numio] [-m maxtracks] [-l lambda] [-d uniform|zipf|seq] [-z exponent] [-R runlength] [-r seed]\n";
+    int opt;
+    while ((opt = getopt(argc, argv, "n:m:l:d:z:R:r:")) != -1) {
+        switch (opt) {
+            case 'n':
+                params.numio = static_cast<long long>(atof(optarg));
+                break;
+            case 'm':
+                params.maxtracks = atoi(optarg);
+                break;
+            case 'l':
+                params.lambda = atof(optarg);
+                break;
+            case 'd':
+                if (!TraceGenerator::parse_distribution(optarg, params.distribution)) {
+                    std::cerr << usage;
+                    return 1;
+                }
+                break;
+            case 'z':
+                params.zipf_exponent = atof(optarg);
+                break;
+            case 'R':
+                params.run_length = atof(optarg);
+                break;
+            case 'r':
+                params.seed = strtoull(optarg, nullptr, 10);
+                break;
+            default:
+                std::cerr << usage;
+                return 1;
+        }
+    }
+    if (params.numio < 0 || params.maxtracks < 1 || params.lambda <= 0 || params.zipf_exponent <= 0 || params.run_length < 1) {
+        std::cerr << usage;
+        return 1;
+    }
+    TraceGenerator generator(params);
+    //lines are collected and written in big chunks instead of one stdio call each
+    std::string out = generator.header();
+    TraceEntry entry;
+    char line[32];
+    while (generator.next(entry)) {
+        out.append(line, snprintf(line, sizeof(line), "%lld %d\n", entry.arrival_time, entry.track));
+        if (out.size() > (1 << 20)) {
+            fwrite(out.data(), 1, out.size(), stdout);
+            out.clear();
+        }
+    }
+    fwrite(out.data(), 1, out.size(), stdout);
+    if (generator.failed()) {
+        std::cerr << generator.error();
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,122 @@
+//parse throughput benchmark for the input readers, compares the old getline plus
+//istringstream loop against the stream reader with the hand rolled scanner, the
+//memory mapped reader, and with the same trace converted to the binary format. the
+//rate for the binary reader is still given relative to the size of the text file so
+//the numbers compare directly. without a file argument it writes a generator style trace
+//(like input_cases/input9 but much longer) to a temporary file first
+
+//example ./bench/parse_bench [tracefile] [lines]
+
+#define IOSCHED_NO_MAIN
+#include "../iosched.cpp"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+
+struct Result {
+    std::size_t lines = 0;
+    long long checksum = 0;
+};
+
+//the way main used to read the file before the scanner 
+static Result parse_istringstream(const std::string& path) {
+    Result result;
+    std::ifstream infile(path);
+    std::string line;
+    while (std::getline(infile, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream iss(line);
+        int arrival_time, track;
+        if (!(iss >> arrival_time >> track)) break;
+        result.lines++;
+        result.checksum += arrival_time ^ track;
+    }
+    return result;
+}
+
+template <typename Reader>
+static Result drain(Reader& reader) {
+    Result result;
+    TraceEntry entry;
+    while (reader.next(entry)) {
+        result.lines++;
+        result.checksum += entry.arrival_time ^ entry.track;
+    }
+    return result;
+}
+
+static Result parse_stream(const std::string& path) {
+    std::ifstream infile(path);
+    TraceReader reader(infile);
+    return drain(reader);
+}
+
+static Result parse_mapped(const std::string& path) {
+    MappedFile file;
+    if (!file.open(path)) return Result();
+    MappedTraceReader reader(file);
+    return drain(reader);
+}
+
+static Result parse_binary(const std::string& path) {
+    MappedFile file;
+    if (!file.open(path) || !is_binary_trace(file)) return Result();
+    BinaryTraceReader reader(file);
+    return drain(reader);
+}
+
+static void measure(const char* name, Result (*parse)(const std::string&), const std::string& path, double bytes) {
+    //first run warms up the page cache so every reader sees the same conditions 
+    parse(path);
+    auto start = std::chrono::steady_clock::now();
+    Result result = parse(path);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::left << std::setw(14) << name << std::right << std::fixed
+              << std::setprecision(1) << std::setw(10) << bytes / seconds / 1e6
+              << std::setprecision(2) << std::setw(14) << result.lines / seconds / 1e6
+              << std::setw(18) << result.checksum << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::string path;
+    bool generated = false;
+    if (argc > 1) {
+        path = argv[1];
+    } else {
+        std::size_t lines = argc > 2 ? std::stoul(argv[2]) : 5000000;
+        path = "/tmp/parse_bench.trace";
+        std::ofstream out(path);
+        std::mt19937 rng(7);
+        std::exponential_distribution<double> gaps(2.4);
+        double time = 0;
+        out << "#io generator\n#numio=" << lines << " maxtracks=512 lambda=2.400000\n";
+        for (std::size_t i = 0; i < lines; i++) {
+            time += 1 + gaps(rng) * 10;
+            out << static_cast<int>(time) << " " << rng() % 512 << "\n";
+        }
+        generated = true;
+    }
+    std::ifstream probe(path, std::ios::binary | std::ios::ate);
+    double bytes = static_cast<double>(probe.tellg());
+    std::cout << std::left << std::setw(14) << "reader" << std::right
+              << std::setw(10) << "MB/s" << std::setw(14) << "Mlines/s"
+              << std::setw(18) << "checksum" << std::endl;
+    measure("istringstream", parse_istringstream, path, bytes);
+    measure("stream", parse_stream, path, bytes);
+    measure("mmap", parse_mapped, path, bytes);
+    std::string binary = path + ".bin";
+    {
+        MappedFile file;
+        if (file.open(path) && convert_trace(file, binary).empty()) {
+            measure("binary", parse_binary, binary, bytes);
+            std::ifstream size(binary, std::ios::binary | std::ios::ate);
+            std::cout << "binary trace is " << std::setprecision(1)
+                      << 100.0 * static_cast<double>(size.tellg()) / bytes << "% of the text size" << std::endl;
+            std::remove(binary.c_str());
+        }
+    }
+    if (generated) std::remove(path.c_str());
+    return 0;
+}
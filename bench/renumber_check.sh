@@ -0,0 +1,60 @@
+#!/bin/bash
+
+# checks that a run never depends on how big the request ids and times get, which is
+# what lets a live run go on for billions of requests. the simulator is built again
+# with the ids renumbered every few thousand requests (IOSCHED_RENUMBER_AT) and has to
+# print exactly what the normal build prints for every scheduler, and a trace moved
+# past 2^31 time units has to come out the same moved by as much. exits with 1 if
+# any output differs
+
+# example ./bench/renumber_check.sh ./iosched 200000
+
+PROG=${1:-./iosched}
+NUMIO=${2:-200000}
+SCHEDS=${SCHEDS:-"N S L C F D B"}
+PROFILE=${PROFILE:-profiles/hdd7200.profile}
+TMP=${TMPDIR:-/tmp}/renumber_check.$$
+
+[[ ! -x ${PROG} ]] && echo "program <$PROG> is not executable" && exit 1
+
+trap "rm -f ${TMP}.*" EXIT
+
+g++ -O2 -pthread -DIOSCHED_RENUMBER_AT=4096 iosched.cpp -o ${TMP}.renumber || exit 1
+
+# the disk keeps up most of the time so the oldest request moves on and the ids get
+# renumbered, with a burst now and then that leaves a few hundred in flight when it
+# happens. reads and writes from a few streams for the deadline and BFQ schedulers
+awk -v n=${NUMIO} 'BEGIN { srand(29); t = 0;
+    for (i = 0; i < n; i++) { if (i % 4000 >= 300) t += int(rand() * 60); printf "%d %d 0 %d %d %d %d\n", t, int(rand() * 64), int(rand() * 64), 1 + int(rand() * 8), rand() < 0.3, int(rand() * 4) } }' > ${TMP}.in
+# the same trace 3e9 time units later
+awk '{ $1 = sprintf("%.0f", $1 + 3000000000); print }' ${TMP}.in > ${TMP}.late
+
+STATUS=0
+report() {
+    if cmp -s $2 $3; then
+        printf "%-30s ok\n" "$1"
+    else
+        printf "%-30s DIFFERS\n" "$1"
+        STATUS=1
+    fi
+}
+
+for s in ${SCHEDS}; do
+    for flags in "" "-Ptext" "-M8" "-Q16,rpo -p ${PROFILE}" "-L1000,20"; do
+        ${PROG} -s${s} ${flags} ${TMP}.in > ${TMP}.out
+        ${TMP}.renumber -s${s} ${flags} ${TMP}.in > ${TMP}.renumbered
+        report "-s${s} ${flags% -p*}" ${TMP}.out ${TMP}.renumbered
+    done
+    # every time column moved back by 3e9. the sum line only has the total time, and
+    # its utilization is counted from time 0 so it can't be the same
+    ${PROG} -s${s} ${TMP}.late | awk '/^SUM/ { $2 -= 3000000000; $4 = "-" } !/^SUM/ { $2 -= 3000000000; $3 -= 3000000000; $4 -= 3000000000 } { print }' > ${TMP}.moved
+    ${PROG} -s${s} ${TMP}.in | awk '/^SUM/ { $4 = "-" } { $1 = $1; print }' > ${TMP}.out
+    report "-s${s} after 2^31" ${TMP}.out ${TMP}.moved
+    # a checkpoint taken after some renumberings resumes on the same ids
+    rm -f ${TMP}.ckpt
+    ${TMP}.renumber -s${s} -C0,${TMP}.ckpt ${TMP}.in > ${TMP}.full
+    cp ${TMP}.full ${TMP}.out
+    ${TMP}.renumber -s${s} -R${TMP}.ckpt ${TMP}.in >> ${TMP}.out
+    report "-s${s} resumed" ${TMP}.full ${TMP}.out
+done
+exit ${STATUS}
@@ -0,0 +1,113 @@
+//scaling benchmark. for every request count from the smallest to the largest in
+//steps of ten it streams a generated trace (see trace_gen.h) through every scheduler
+//and reports wall time, requests per second, peak RSS and heap allocations of the
+//run. every run is a forked child so the peak RSS is that of the run alone, the
+//parent reads the rest from a pipe. nothing is written to disk and only the sum
+//line is computed, so this is the simulator and the generator and nothing else
+
+//example ./bench/scale_bench [from] [to] [maxtracks] [lambda] [uniform|zipf|seq] [schedulers]
+
+#define IOSCHED_NO_MAIN
+#include "../iosched.cpp"
+#include "trace_gen.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+static unsigned long long allocations = 0;
+
+void* operator new(std::size_t size) {
+    allocations++;
+    void* pointer = malloc(size ? size : 1);
+    if (pointer == nullptr) throw std::bad_alloc();
+    return pointer;
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* pointer) noexcept { free(pointer); }
+void operator delete[](void* pointer) noexcept { free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { free(pointer); }
+
+struct NullSink {
+    void request(long long, long long, long long, long long) {}
+};
+
+//what a child sends back, ok is false if the generated times overflowed
+struct RunResult {
+    double seconds;
+    unsigned long long allocations;
+    unsigned long long completed;
+    bool ok;
+};
+
+static RunResult run_once(char letter, const TraceGenerator::Params& params) {
+    TraceGenerator source(params);
+    NullSink sink;
+    SimulationSummary summary;
+    SimulationOptions options;
+    RunResult result{};
+    unsigned long long before = allocations;
+    auto start = std::chrono::steady_clock::now();
+    Schedulers::with_scheduler(letter, [&](auto& scheduler) {
+        NoTelemetry telemetry;
+        result.ok = run_simulation(scheduler, source, sink, summary, options, telemetry);
+        return result.ok;
+    });
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.allocations = allocations - before;
+    result.completed = summary.completed;
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    long long from = argc > 1 ? static_cast<long long>(atof(argv[1])) : 1000;
+    long long to = argc > 2 ? static_cast<long long>(atof(argv[2])) : 100000000;
+    TraceGenerator::Params params;
+    //defaults keep the disk below saturation for FIFO
+    params.maxtracks = argc > 3 ? atoi(argv[3]) : 32;
+    params.lambda = argc > 4 ? atof(argv[4]) : 0.05;
+    if (argc > 5 && !TraceGenerator::parse_distribution(argv[5], params.distribution)) {
+        std::cerr << "Unknown distribution: " << argv[5] << std::endl;
+        return 1;
+    }
+    std::string letters = argc > 6 ? argv[6] : Schedulers::letters();
+    std::cout << "maxtracks=" << params.maxtracks << " lambda=" << params.lambda << std::endl;
+    std::cout << std::setw(10) << "requests" << "  sched" << std::setw(10) << "seconds" << std::setw(14) << "req/s"
+              << std::setw(12) << "peak MB" << std::setw(14) << "allocations" << std::endl;
+    for (long long numio = from; numio <= to; numio *= 10) {
+        params.numio = numio;
+        for (char letter : letters) {
+            int fds[2];
+            if (pipe(fds) != 0) 
+            {
+                return 1;
+            }
+            std::cout.flush();
+            pid_t child = fork();
+            if (child == 0) {
+                RunResult result = run_once(letter, params);
+                ssize_t written = write(fds[1], &result, sizeof(result));
+                _exit(written == static_cast<ssize_t>(sizeof(result)) ? 0 : 1);
+            }
+            close(fds[1]);
+            RunResult result{};
+            bool received = read(fds[0], &result, sizeof(result)) == static_cast<ssize_t>(sizeof(result));
+            close(fds[0]);
+            int status = 0;
+            struct rusage usage;
+            wait4(child, &status, 0, &usage);
+            std::cout << std::setw(10) << numio << "  " << std::setw(5) << letter;
+            if (!received || !result.ok) {
+                std::cout << "  failed, the generated times overflow" << std::endl;
+                continue;
+            }
+            std::cout << std::fixed << std::setprecision(3) << std::setw(10) << result.seconds << std::setprecision(0)
+                      << std::setw(14) << result.completed / std::max(result.seconds, 1e-9) << std::setprecision(1)
+                      << std::setw(12) << usage.ru_maxrss / 1024.0 << std::setw(14) << result.allocations << std::endl;
+        }
+    }
+    return 0;
+}
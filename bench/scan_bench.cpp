@@ -0,0 +1,111 @@
+//microbenchmark for the flat queue scan kernels used by LOOK and FLOOK. for every
+//queue size it times one directional scan with each kernel, and a steady state
+//LOOK style dispatch (pick the closest request going up, else going down, remove it
+//and add a new one) on the flat arrays against the same on a TrackIndex. this is
+//what AdaptiveTrackQueue::FLAT_LIMIT was picked from
+
+//example ./bench/scan_bench 8 64 512 4096
+
+#define IOSCHED_NO_MAIN
+#include "../iosched.cpp"
+
+#include <chrono>
+#include <random>
+#include <string>
+
+static const int MAX_TRACKS = 1 << 16;
+
+static double elapsed_ns(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+//ns per scan of count requests, alternating directions and head positions 
+static double time_scan(ScanKernel kernel, const int* tracks, const RequestId* ids, std::size_t count, std::size_t rounds) {
+    std::size_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < rounds; i++) {
+        int current_track = static_cast<int>((i * 7919) % MAX_TRACKS);
+        checksum += kernel(tracks, ids, count, current_track, i & 1 ? SCAN_DOWN : SCAN_UP);
+    }
+    double ns = elapsed_ns(start) / rounds;
+    //keeps the compiler from dropping the loop 
+    if (checksum == 1) std::cout << "";
+    return ns;
+}
+
+//ns per LOOK style dispatch on a queue that stays at count requests 
+template <typename Queue>
+static double time_dispatch(Queue& queue, std::size_t count, std::size_t rounds, std::mt19937& rng) {
+    std::uniform_int_distribution<int> tracks(0, MAX_TRACKS - 1);
+    RequestId next_id = 0;
+    for (; next_id < count; next_id++) queue.insert(next_id, tracks(rng));
+    int current_track = 0;
+    int direction = 1;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < rounds; i++) {
+        std::uint64_t pick = direction == 1 ? queue.at_or_above(current_track) : queue.at_or_below(current_track);
+        if (pick == TrackIndex::NONE) {
+            direction = -direction;
+            pick = direction == 1 ? queue.at_or_above(current_track) : queue.at_or_below(current_track);
+        }
+        current_track = TrackIndex::track_of(pick);
+        queue.erase(pick);
+        queue.insert(next_id++, tracks(rng));
+    }
+    return elapsed_ns(start) / rounds;
+}
+
+//the flat half of AdaptiveTrackQueue without the switch to the tree, so it can be
+//measured past FLAT_LIMIT 
+struct FlatQueue {
+    std::vector<int> tracks;
+    std::vector<RequestId> ids;
+    std::size_t last = 0;
+    void insert(RequestId id, int track) {
+        tracks.push_back(track);
+        ids.push_back(id);
+    }
+    std::uint64_t lookup(int track, ScanDirection direction) {
+        last = scan_closest(tracks.data(), ids.data(), tracks.size(), track, direction);
+        return last == tracks.size() ? TrackIndex::NONE : TrackIndex::key(tracks[last], ids[last]);
+    }
+    std::uint64_t at_or_above(int track) { return lookup(track, SCAN_UP); }
+    std::uint64_t at_or_below(int track) { return lookup(track, SCAN_DOWN); }
+    void erase(std::uint64_t) {
+        tracks[last] = tracks.back();
+        ids[last] = ids.back();
+        tracks.pop_back();
+        ids.pop_back();
+    }
+};
+
+int main(int argc, char* argv[]) {
+    std::vector<std::size_t> sizes;
+    for (int i = 1; i < argc; i++) sizes.push_back(std::stoul(argv[i]));
+    if (sizes.empty()) sizes = {8, 32, 128, 256, 512, 1024, 2048, 4096};
+    std::cout << "dispatch kernel: "
+              << (scan_closest == scan_closest_scalar ? "scalar" : scan_closest == scan_closest_sse41 ? "sse4.1" : "avx2") << std::endl;
+    std::cout << std::setw(8) << "pending" << std::setw(10) << "scalar" << std::setw(10) << "sse4.1"
+              << std::setw(10) << "avx2" << std::setw(12) << "flat disp" << std::setw(12) << "tree disp"
+              << "   (ns)" << std::endl;
+    std::mt19937 rng(3);
+    for (std::size_t count : sizes) {
+        std::vector<int> tracks(count);
+        std::vector<RequestId> ids(count);
+        for (std::size_t i = 0; i < count; i++) {
+            tracks[i] = static_cast<int>(rng() % MAX_TRACKS);
+            ids[i] = static_cast<RequestId>(i);
+        }
+        std::size_t rounds = std::max<std::size_t>(1000, 20000000 / count);
+        std::cout << std::setw(8) << count << std::fixed << std::setprecision(1)
+                  << std::setw(10) << time_scan(scan_closest_scalar, tracks.data(), ids.data(), count, rounds)
+                  << std::setw(10) << time_scan(scan_closest_sse41, tracks.data(), ids.data(), count, rounds)
+                  << std::setw(10) << time_scan(scan_closest_avx2, tracks.data(), ids.data(), count, rounds);
+        FlatQueue flat;
+        TrackIndex tree;
+        std::size_t dispatches = std::max<std::size_t>(10000, 2000000 / count);
+        std::cout << std::setw(12) << time_dispatch(flat, count, dispatches, rng)
+                  << std::setw(12) << time_dispatch(tree, count, dispatches, rng) << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,75 @@
+//microbenchmark for the scheduler queues, fills a scheduler with a given number of
+//pending requests on random tracks and then drains it again, reporting the average
+//cost of an add and of a dispatch in nanoseconds
+
+//example ./bench/sched_bench 10000 100000 1000000
+
+#define IOSCHED_NO_MAIN
+#include "../iosched.cpp"
+
+#include <chrono>
+#include <random>
+#include <string>
+
+//tracks are drawn from this range so there are plenty of duplicate tracks at the
+//larger queue sizes which exercises the id tie breaking 
+static const int MAX_TRACKS = 1 << 16;
+
+static double elapsed_ns(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename Scheduler>
+static void run(const char* name, std::size_t count) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> tracks(0, MAX_TRACKS - 1);
+    std::vector<int> requests(count);
+    for (auto& track : requests) {
+        track = tracks(rng);
+    }
+    Scheduler scheduler;
+    //fill the queue to the requested depth 
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < count; i++) {
+        scheduler.add_request(static_cast<RequestId>(i), requests[i]);
+    }
+    double add_ns = elapsed_ns(start);
+    //then drain it, moving the head to every dispatched request like the simulator does 
+    int current_track = 0;
+    long long checksum = 0;
+    start = std::chrono::steady_clock::now();
+    for (RequestId request; (request = scheduler.get_next_request(current_track)) != NO_REQUEST;) {
+        checksum += std::abs(requests[request] - current_track);
+        current_track = requests[request];
+    }
+    double dispatch_ns = elapsed_ns(start);
+    std::cout << std::left << std::setw(8) << name << std::right
+              << std::setw(10) << count
+              << std::fixed << std::setprecision(1)
+              << std::setw(12) << add_ns / count
+              << std::setw(14) << dispatch_ns / count
+              << std::setw(16) << checksum << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::size_t> sizes;
+    for (int i = 1; i < argc; i++) {
+        sizes.push_back(std::stoul(argv[i]));
+    }
+    if (sizes.empty()) {
+        sizes = {10000, 100000, 1000000};
+    }
+    std::cout << std::left << std::setw(8) << "sched" << std::right
+              << std::setw(10) << "pending"
+              << std::setw(12) << "ns/add"
+              << std::setw(14) << "ns/dispatch"
+              << std::setw(16) << "movement" << std::endl;
+    for (std::size_t count : sizes) {
+        run<FIFOScheduler>("FIFO", count);
+        run<SSTFScheduler>("SSTF", count);
+        run<LOOKScheduler>("LOOK", count);
+        run<CLOOKScheduler>("CLOOK", count);
+        run<FLOOKScheduler>("FLOOK", count);
+    }
+    return 0;
+}
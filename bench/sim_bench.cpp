@@ -0,0 +1,101 @@
+//end to end simulation benchmark comparing the loop instantiated for each concrete
+//scheduler (what the registry runs) against the same loop going through the virtual
+//IOScheduler interface. the trace is the input_cases/ corpus appended to itself
+//with shifted arrival times until it has the requested number of requests
+
+//example ./bench/sim_bench [requests] [inputdir]
+
+#define IOSCHED_NO_MAIN
+#include "../iosched.cpp"
+
+#include <chrono>
+#include <string>
+
+//kept out of line so the compiler can't see the dynamic type and devirtualize 
+__attribute__((noinline)) static bool run_virtual(IOScheduler& scheduler, const std::vector<TraceEntry>& trace,
+                                                  std::ostream& out, const SimulationOptions& options) {
+    TraceArraySource source(trace);
+    return simulate_io_scheduler(scheduler, source, out, options);
+}
+
+template <typename Scheduler>
+__attribute__((noinline)) static bool run_direct(Scheduler& scheduler, const std::vector<TraceEntry>& trace,
+                                                 std::ostream& out, const SimulationOptions& options) {
+    TraceArraySource source(trace);
+    return simulate_io_scheduler(scheduler, source, out, options);
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename Scheduler>
+static void compare(const char* name, const std::vector<TraceEntry>& trace) {
+    //only the sum line, we are measuring the loop and not the output 
+    SimulationOptions options;
+    options.quiet = true;
+    std::ostringstream virtual_out, direct_out;
+    //best of three runs each 
+    double virtual_seconds = 1e30, direct_seconds = 1e30;
+    for (int round = 0; round < 3; round++) {
+        {
+            Scheduler scheduler;
+            virtual_out.str("");
+            auto start = std::chrono::steady_clock::now();
+            run_virtual(scheduler, trace, virtual_out, options);
+            virtual_seconds = std::min(virtual_seconds, seconds_since(start));
+        }
+        {
+            Scheduler scheduler;
+            direct_out.str("");
+            auto start = std::chrono::steady_clock::now();
+            run_direct(scheduler, trace, direct_out, options);
+            direct_seconds = std::min(direct_seconds, seconds_since(start));
+        }
+    }
+    std::cout << std::left << std::setw(8) << name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(12) << virtual_seconds << std::setw(12) << direct_seconds
+              << std::setprecision(2) << std::setw(10) << virtual_seconds / direct_seconds << "x"
+              << (virtual_out.str() == direct_out.str() ? "" : "   OUTPUT DIFFERS") << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t count = argc > 1 ? std::stoul(argv[1]) : 2000000;
+    std::string input_dir = argc > 2 ? argv[2] : "input_cases";
+    std::vector<std::vector<TraceEntry>> corpus;
+    for (int i = 0; i < 10; i++) {
+        MappedFile file;
+        if (!file.open(input_dir + "/input" + std::to_string(i))) continue;
+        MappedTraceReader reader(file);
+        std::vector<TraceEntry> requests;
+        TraceEntry entry;
+        while (reader.next(entry)) requests.push_back(entry);
+        if (!requests.empty()) corpus.push_back(requests);
+    }
+    if (corpus.empty()) {
+        std::cerr << "no traces found in " << input_dir << std::endl;
+        return 1;
+    }
+    //append the corpus files one after the other, every copy starts a bit after the
+    //last arrival of the one before 
+    std::vector<TraceEntry> trace;
+    trace.reserve(count);
+    long long offset = 0;
+    for (std::size_t copy = 0; trace.size() < count; copy++) {
+        const std::vector<TraceEntry>& requests = corpus[copy % corpus.size()];
+        for (std::size_t i = 0; i < requests.size() && trace.size() < count; i++) {
+            trace.push_back({requests[i].arrival_time + offset, requests[i].track});
+        }
+        offset = trace.back().arrival_time + 1;
+    }
+    std::cout << trace.size() << " requests" << std::endl;
+    std::cout << std::left << std::setw(8) << "sched" << std::right
+              << std::setw(12) << "virtual s" << std::setw(12) << "direct s"
+              << std::setw(11) << "speedup" << std::endl;
+    compare<FIFOScheduler>("FIFO", trace);
+    compare<SSTFScheduler>("SSTF", trace);
+    compare<LOOKScheduler>("LOOK", trace);
+    compare<CLOOKScheduler>("CLOOK", trace);
+    compare<FLOOKScheduler>("FLOOK", trace);
+    return 0;
+}
@@ -0,0 +1,125 @@
+//parallel mode benchmark. a generated trace (see trace_gen.h) is simulated once in a
+//single run and then cut into pieces for every scheduler, the times of every request
+//and the sum line of both have to be identical. reports the wall time of both, how many
+//pieces the trace was cut into and how many of them guessed their start wrong and ran
+//again. before that a few small traces that once came out different are checked for
+//every scheduler. exits with 1 if any result differs
+
+//example ./bench/split_bench [requests] [pieces] [threads] [maxtracks] [lambda] [schedulers]
+
+#define IOSCHED_NO_MAIN
+#include "../iosched.cpp"
+#include "trace_gen.h"
+
+#include <chrono>
+
+//times of every request by id, the same arrays the parallel mode fills
+struct TimesSink {
+    std::vector<long long>& start_time;
+    std::vector<long long>& end_time;
+    void request(long long id, long long, long long start, long long end) {
+        start_time[id] = start;
+        end_time[id] = end;
+    }
+};
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool same(const SimulationSummary& a, const SimulationSummary& b) {
+    return a.total_time == b.total_time && a.total_movement == b.total_movement && a.busy_time == b.busy_time
+           && a.total_turnaround == b.total_turnaround && a.total_wait_time == b.total_wait_time
+           && a.max_wait_time == b.max_wait_time && a.completed == b.completed && a.merged == b.merged;
+}
+
+//simulates the trace in a single run and in pieces, true if both agree 
+static bool split_matches(char letter, const std::vector<TraceEntry>& trace, std::size_t pieces, unsigned threads,
+                          const SimulationOptions& options) {
+    std::vector<long long> start_time(trace.size()), end_time(trace.size());
+    SimulationSummary single;
+    Schedulers::with_scheduler(letter, [&](auto& scheduler) {
+        TraceArraySource source(trace);
+        TimesSink sink{start_time, end_time};
+        NoTelemetry telemetry;
+        return run_simulation(scheduler, source, sink, single, options, telemetry);
+    });
+    std::vector<long long> split_start(trace.size()), split_end(trace.size());
+    SimulationSummary split;
+    simulate_split(letter, trace, pieces, threads, options, split_start, split_end, split);
+    return same(single, split) && start_time == split_start && end_time == split_end;
+}
+
+//the disk finishes the first piece exactly when the second one starts. cutting there
+//used to let BFQ find nothing to do at that time and expire its active stream, while
+//the single run already had the arrivals of that time queued 
+static std::vector<TraceEntry> finish_at_cut_trace() {
+    std::vector<TraceEntry> trace;
+    TraceEntry entry{0, 0};
+    for (int i = 0; i < 17; i++) trace.push_back(entry);
+    entry.track = 100;
+    trace.push_back(entry);
+    entry.arrival_time = 100;
+    entry.track = 0;
+    entry.size = 8;
+    for (int i = 0; i < 11; i++) {
+        for (int stream = 0; stream < 2; stream++) {
+            entry.stream = stream;
+            trace.push_back(entry);
+        }
+    }
+    return trace;
+}
+
+int main(int argc, char* argv[]) {
+    TraceGenerator::Params params;
+    params.numio = argc > 1 ? static_cast<long long>(atof(argv[1])) : 4000000;
+    std::size_t pieces = argc > 2 ? std::stoul(argv[2]) : 16;
+    unsigned threads = argc > 3 ? static_cast<unsigned>(atoi(argv[3])) : std::max(1u, std::thread::hardware_concurrency());
+    params.maxtracks = argc > 4 ? atoi(argv[4]) : 32;
+    params.lambda = argc > 5 ? atof(argv[5]) : 0.05;
+    std::string letters = argc > 6 ? argv[6] : Schedulers::letters();
+    std::vector<TraceEntry> trace;
+    TraceGenerator generator(params);
+    TraceEntry entry;
+    while (generator.next(entry)) trace.push_back(entry);
+    if (generator.failed()) {
+        std::cerr << generator.error();
+        return 1;
+    }
+    std::cout << trace.size() << " requests, " << pieces << " pieces, " << threads << " threads" << std::endl;
+    std::cout << "sched   single s   split s  speedup  cut  rerun" << std::endl;
+    int status = 0;
+    SimulationOptions options;
+    std::vector<TraceEntry> finish_at_cut = finish_at_cut_trace();
+    for (char letter : letters) {
+        if (!split_matches(letter, finish_at_cut, 2, threads, options)) {
+            std::cout << letter << " DIFFERS when the disk finishes at the cut" << std::endl;
+            status = 1;
+        }
+    }
+    for (char letter : letters) {
+        std::vector<long long> start_time(trace.size()), end_time(trace.size());
+        SimulationSummary single;
+        auto start = std::chrono::steady_clock::now();
+        Schedulers::with_scheduler(letter, [&](auto& scheduler) {
+            TraceArraySource source(trace);
+            TimesSink sink{start_time, end_time};
+            NoTelemetry telemetry;
+            return run_simulation(scheduler, source, sink, single, options, telemetry);
+        });
+        double single_seconds = seconds_since(start);
+        std::vector<long long> split_start(trace.size()), split_end(trace.size());
+        SimulationSummary split;
+        start = std::chrono::steady_clock::now();
+        std::size_t reruns = simulate_split(letter, trace, pieces, threads, options, split_start, split_end, split);
+        double split_seconds = seconds_since(start);
+        bool identical = same(single, split) && start_time == split_start && end_time == split_end;
+        std::cout << std::left << std::setw(6) << letter << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(10) << single_seconds << std::setw(10) << split_seconds << std::setprecision(2)
+                  << std::setw(8) << single_seconds / split_seconds << "x" << std::setw(5) << split_points(trace, pieces).size() - 1
+                  << std::setw(7) << reruns << (identical ? "" : "   DIFFERS") << std::endl;
+        if (!identical) status = 1;
+    }
+    return status;
+}
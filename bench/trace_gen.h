@@ -0,0 +1,129 @@
+//synthetic traces for the generator and the scaling benchmark, in the spirit of the
+//generator the input_cases/ files came from. arrivals are a poisson process with
+//rate lambda requests per time unit and tracks are uniform, zipf distributed or
+//sequential runs over [0, maxtracks). it is a source like the trace readers so a
+//benchmark can stream millions of requests into the simulator without a file.
+//include ../iosched.cpp first
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+class TraceGenerator {
+public:
+    enum Distribution { UNIFORM, ZIPF, SEQUENTIAL };
+    struct Params {
+        long long numio = 500;
+        int maxtracks = 512;
+        double lambda = 0.02;
+        Distribution distribution = UNIFORM;
+        //zipf exponent and the mean length of a sequential run
+        double zipf_exponent = 1.0;
+        double run_length = 32;
+        std::uint64_t seed = 1;
+    };
+private:
+    Params params;
+    long long generated = 0;
+    double clock = 0;
+    int last_track = 0;
+    bool overflow = false;
+    std::uint64_t state;
+    //zipf sampling by rejection inversion (hormann and derflinger), constant time
+    //whatever the number of tracks
+    double zipf_h_x1 = 0, zipf_h_n = 0, zipf_s = 0;
+
+    //splitmix64, fast and good enough for workloads
+    std::uint64_t next_random() {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    //uniform in [0, 1)
+    double uniform() { return (next_random() >> 11) * (1.0 / 9007199254740992.0); }
+    static double helper1(double x) { return std::fabs(x) > 1e-8 ? std::log1p(x) / x : 1 - x * (0.5 - x * (1.0 / 3 - 0.25 * x)); }
+    static double helper2(double x) { return std::fabs(x) > 1e-8 ? std::expm1(x) / x : 1 + x * 0.5 * (1 + x * (1.0 / 3) * (1 + 0.25 * x)); }
+    double zipf_h(double x) const { return std::exp(-params.zipf_exponent * std::log(x)); }
+    double zipf_h_integral(double x) const {
+        double log_x = std::log(x);
+        return helper2((1 - params.zipf_exponent) * log_x) * log_x;
+    }
+    double zipf_h_integral_inverse(double x) const {
+        double t = std::max(-1.0, x * (1 - params.zipf_exponent));
+        return std::exp(helper1(t) * x);
+    }
+    //rank 1 is the hottest
+    long long zipf_rank() {
+        while (true) {
+            double u = zipf_h_n + uniform() * (zipf_h_x1 - zipf_h_n);
+            double x = zipf_h_integral_inverse(u);
+            long long k = std::min<long long>(std::max<long long>(static_cast<long long>(x + 0.5), 1), params.maxtracks);
+            if (k - x <= zipf_s || u >= zipf_h_integral(k + 0.5) - zipf_h(static_cast<double>(k))) return k;
+        }
+    }
+    int next_track() {
+        switch (params.distribution) {
+            case ZIPF:
+                //scatter the hot ranks over the disk instead of piling them up at track 0,
+                //the multiplier is prime so this is a permutation of the tracks
+                return static_cast<int>(static_cast<std::uint64_t>(zipf_rank() - 1) * 2654435761ull % static_cast<std::uint64_t>(params.maxtracks));
+            case SEQUENTIAL:
+                if (generated == 0 || uniform() * params.run_length < 1)
+                {
+                    return static_cast<int>(next_random() % static_cast<std::uint64_t>(params.maxtracks));
+                }
+                return (last_track + 1) % params.maxtracks;
+            default:
+                return static_cast<int>(next_random() % static_cast<std::uint64_t>(params.maxtracks));
+        }
+    }
+public:
+    explicit TraceGenerator(const Params& params) : params(params), state(params.seed) {
+        if (params.distribution == ZIPF) {
+            zipf_h_x1 = zipf_h_integral(1.5) - 1;
+            zipf_h_n = zipf_h_integral(params.maxtracks + 0.5);
+            zipf_s = 2 - zipf_h_integral_inverse(zipf_h_integral(2.5) - zipf_h(2));
+        }
+    }
+    //the two comment lines the input_cases/ files start with
+    std::string header() const {
+        static const char* names[] = {"uniform", "zipf", "seq"};
+        char line[256];
+        snprintf(line, sizeof(line), "#io generator\n#numio=%lld maxtracks=%d lambda=%f dist=%s\n", params.numio, params.maxtracks,
+                 params.lambda, names[params.distribution]);
+        return line;
+    }
+    bool next(TraceEntry& entry) {
+        if (generated == params.numio || overflow)
+        {
+            return false;
+        }
+        //exponential gaps make the arrivals a poisson process
+        clock += -std::log1p(-uniform()) / params.lambda;
+        if (clock >= static_cast<double>(std::numeric_limits<long long>::max()))
+        {
+            overflow = true;
+            return false;
+        }
+        entry = TraceEntry();
+        entry.arrival_time = static_cast<long long>(clock);
+        entry.track = last_track = next_track();
+        generated++;
+        return true;
+    }
+    //times are long longs in the simulator, a trace that would run past them ends early
+    bool failed() const { return overflow; }
+    std::string error() const {
+        return "Arrival time of request " + std::to_string(generated) + " doesn't fit in a long long, lower numio or raise lambda\n";
+    }
+    std::size_t size_hint() const { return static_cast<std::size_t>(params.numio); }
+    //parses uniform, zipf or seq
+    static bool parse_distribution(const std::string& name, Distribution& distribution) {
+        if (name == "uniform") distribution = UNIFORM;
+        else if (name == "zipf") distribution = ZIPF;
+        else if (name == "seq") distribution = SEQUENTIAL;
+        else return false;
+        return true;
+    }
+};
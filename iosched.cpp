@@ -9,599 +9,3761 @@
 #include <algorithm>
 #include <iomanip>  
 #include <list>
+#include <set>
+#include <unordered_map>
 #include <limits>
+#include <memory>
+#include <cstdio>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
-//structure that represents a IO request object 
-struct IORequest {
-    //represents ID of request
-    int id;
-    //represents arrival time of request
-    int arrival_time;
-    //represents track destination of request
-    int track;
-    //trivial intialization of the requests start and end time 
-    int start_time = -1;
-    int end_time = -1;
-    //intialization as we intialize request objects when we read the input files
-    //which gives us arrival time and track destination for each requests 
-    //and we calculate id as we read each line 
-    IORequest(int id, int arrival, int track)
-            : id(id), arrival_time(arrival), track(track) {}
-};
-//base class for the scheduling algorithms 
+//handle of a request, its id which is the order it was read in. schedulers and the
+//simulator pass these around instead of pointers to request objects 
+typedef std::uint32_t RequestId;
+//what a scheduler returns when it has nothing pending 
+const RequestId NO_REQUEST = std::numeric_limits<RequestId>::max();
+//ids only have to tell apart the requests in flight. once they get this high the
+//simulator renumbers those from about 0, keeping their order, so a live run that
+//goes on for billions of requests never runs into NO_REQUEST. the line printed for
+//a request still has its position among all the requests simulated, which is its
+//order in the input except under -L with a window, there it is the order after the
+//window sorted the arrivals. build with a small value (-DIOSCHED_RENUMBER_AT=<n>)
+//to try the renumbering on a short trace 
+#ifndef IOSCHED_RENUMBER_AT
+#define IOSCHED_RENUMBER_AT (1u << 31)
+#endif
+//state of a simulation in a checkpoint (-C and -R). every number is a zigzag varint so
+//ids, tracks and counts mostly take a byte or two whatever their sign 
+class CheckpointWriter {
+private:
+    std::string bytes;
+public:
+    void put(long long value) {
+        std::uint64_t v = (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+        while (v >= 0x80) {
+            bytes.push_back(static_cast<char>(v | 0x80));
+            v >>= 7;
+        }
+        bytes.push_back(static_cast<char>(v));
+    }
+    void put_double(double value) {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        put(static_cast<long long>(bits));
+    }
+    const std::string& data() const { return bytes; }
+    void clear() { bytes.clear(); }
+};
+//reads back what a CheckpointWriter wrote. a truncated or corrupt checkpoint makes
+//every further read return 0 and failed() true instead of reading past the end 
+class CheckpointReader {
+private:
+    const char* pos;
+    const char* end;
+    bool broken = false;
+public:
+    explicit CheckpointReader(const std::string& bytes) : pos(bytes.data()), end(bytes.data() + bytes.size()) {}
+    long long get() {
+        std::uint64_t v = 0;
+        for (int shift = 0;; shift += 7) {
+            if (broken || pos == end || shift > 63) 
+            {
+                broken = true;
+                return 0;
+            }
+            unsigned char byte = static_cast<unsigned char>(*pos++);
+            v |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) break;
+        }
+        return static_cast<long long>(v >> 1) ^ -static_cast<long long>(v & 1);
+    }
+    double get_double() {
+        std::uint64_t bits = static_cast<std::uint64_t>(get());
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    //a count of things that follow, each takes at least a byte so a count larger than
+    //what is left can only come from a broken file 
+    std::size_t get_count() {
+        long long count = get();
+        if (count < 0 || count > end - pos) 
+        {
+            broken = true;
+            return 0;
+        }
+        return static_cast<std::size_t>(count);
+    }
+    bool failed() const { return broken; }
+    bool at_end() const { return pos == end; }
+};
+//state of the requests that are in the simulation right now, kept as parallel arrays
+//of arrival, track, start and end time addressed by request id instead of a struct
+//per request. the arrays are a ring over the ids from the oldest request that hasn't
+//been printed yet to the newest arrival, so a slot is reused once its request is
+//printed and the ring only grows when that many requests are in flight at once 
+class RequestTable {
+private:
+    std::vector<long long> arrival_times;
+    std::vector<int> tracks;
+    //sector on the track and size in sectors, only used by the service model 
+    std::vector<int> sectors;
+    std::vector<int> sizes;
+    //write flag and stream id, only used by the deadline and BFQ schedulers 
+    std::vector<int> writes;
+    std::vector<int> streams;
+    //trivial intialization of the requests start and end time is -1
+    std::vector<long long> start_times;
+    std::vector<long long> end_times;
+    //oldest request still in the table and the id the next one will get 
+    RequestId first = 0;
+    RequestId next = 0;
+    //position in the input of id 0, how far the ids were renumbered 
+    std::uint64_t base = 0;
+    //capacity is a power of two so the slot of an id is just id & mask 
+    std::size_t mask = 0;
+    //doubles the capacity, every live request moves to its slot for the new mask 
+    void grow() {
+        std::size_t capacity = std::max<std::size_t>(16, 2 * (mask + 1));
+        std::vector<long long> new_arrivals(capacity), new_starts(capacity), new_ends(capacity);
+        std::vector<int> new_tracks(capacity), new_sectors(capacity), new_sizes(capacity), new_writes(capacity), new_streams(capacity);
+        for (RequestId id = first; id != next; id++) {
+            new_arrivals[id & (capacity - 1)] = arrival_times[id & mask];
+            new_tracks[id & (capacity - 1)] = tracks[id & mask];
+            new_sectors[id & (capacity - 1)] = sectors[id & mask];
+            new_sizes[id & (capacity - 1)] = sizes[id & mask];
+            new_writes[id & (capacity - 1)] = writes[id & mask];
+            new_streams[id & (capacity - 1)] = streams[id & mask];
+            new_starts[id & (capacity - 1)] = start_times[id & mask];
+            new_ends[id & (capacity - 1)] = end_times[id & mask];
+        }
+        arrival_times.swap(new_arrivals);
+        tracks.swap(new_tracks);
+        sectors.swap(new_sectors);
+        sizes.swap(new_sizes);
+        writes.swap(new_writes);
+        streams.swap(new_streams);
+        start_times.swap(new_starts);
+        end_times.swap(new_ends);
+        mask = capacity - 1;
+    }
+public:
+    //adds a request that just arrived and returns its id 
+    RequestId add(long long arrival_time, int track, int sector = 0, int size = 1, int write = 0, int stream = 0) {
+        if (next - first == arrival_times.size()) 
+        {
+            grow();
+        }
+        std::size_t slot = next & mask;
+        arrival_times[slot] = arrival_time;
+        tracks[slot] = track;
+        sectors[slot] = sector;
+        sizes[slot] = size;
+        writes[slot] = write;
+        streams[slot] = stream;
+        start_times[slot] = -1;
+        end_times[slot] = -1;
+        return next++;
+    }
+    bool empty() const { return first == next; }
+    //oldest request still in the table, the next one to be printed 
+    RequestId front() const { return first; }
+    void pop_front() { first++; }
+    long long arrival_time(RequestId id) const { return arrival_times[id & mask]; }
+    int track(RequestId id) const { return tracks[id & mask]; }
+    int sector(RequestId id) const { return sectors[id & mask]; }
+    int size(RequestId id) const { return sizes[id & mask]; }
+    bool write(RequestId id) const { return writes[id & mask] != 0; }
+    int stream(RequestId id) const { return streams[id & mask]; }
+    long long& start_time(RequestId id) { return start_times[id & mask]; }
+    long long& end_time(RequestId id) { return end_times[id & mask]; }
+    //how many requests were ever added, the position in the input 
+    std::uint64_t added() const { return base + next; }
+    //position of a request in the input, what its line is printed with 
+    long long index(RequestId id) const { return static_cast<long long>(base + id); }
+    //once the ids are high, as soon as the oldest request left the first slots 
+    bool renumber_due() const { return next >= IOSCHED_RENUMBER_AT && (first & ~static_cast<RequestId>(mask)) != 0; }
+    //renumbers the requests in the table down by the returned offset, everything
+    //else that holds their ids has to follow. the offset is a multiple of the
+    //capacity so every request keeps its slot 
+    RequestId renumber() {
+        RequestId offset = first & ~static_cast<RequestId>(mask);
+        first -= offset;
+        next -= offset;
+        base += offset;
+        return offset;
+    }
+    void save(CheckpointWriter& out) const {
+        out.put(static_cast<long long>(base));
+        out.put(first);
+        out.put(next);
+        for (RequestId id = first; id != next; id++) {
+            std::size_t slot = id & mask;
+            for (long long value : {arrival_times[slot], static_cast<long long>(tracks[slot]), static_cast<long long>(sectors[slot]), static_cast<long long>(sizes[slot]),
+                                    static_cast<long long>(writes[slot]), static_cast<long long>(streams[slot]), start_times[slot], end_times[slot]}) {
+                out.put(value);
+            }
+        }
+    }
+    void load(CheckpointReader& in) {
+        base = static_cast<std::uint64_t>(in.get());
+        first = next = static_cast<RequestId>(in.get());
+        RequestId last = static_cast<RequestId>(in.get());
+        while (next != last && !in.failed()) {
+            long long values[8];
+            for (long long& value : values) value = in.get();
+            RequestId id = add(values[0], static_cast<int>(values[1]), static_cast<int>(values[2]), static_cast<int>(values[3]), static_cast<int>(values[4]),
+                               static_cast<int>(values[5]));
+            start_time(id) = values[6];
+            end_time(id) = values[7];
+        }
+    }
+};
+//how long the disk takes to serve a request. the default is the original model
+//where moving one track takes one time unit and nothing else costs anything, a
+//device profile (-p) can replace it with a seek curve that is sqrt shaped for short
+//seeks and linear for long ones, a settle time after every seek, rotational latency
+//until the requests sector comes around and a transfer time per sector 
+struct ServiceModel {
+    enum Seek { LINEAR, CURVE };
+    Seek seek = LINEAR;
+    //linear seek, time per track 
+    double track_time = 1;
+    //seek curve, short_base + short_sqrt * sqrt(distance) below boundary tracks and
+    //long_base + long_track * distance from there on 
+    double short_base = 0;
+    double short_sqrt = 0;
+    double long_base = 0;
+    double long_track = 0;
+    long long boundary = 0;
+    //added to every seek that moves the head 
+    long long settle = 0;
+    //time of one revolution and sectors per track, rotational latency is off if either is 0 
+    long long rotation = 0;
+    long long sectors = 0;
+    //time to transfer one sector of the request 
+    double transfer = 0;
+    //SSTF picks by modeled positioning time instead of track distance, looking at
+    //no more than rank_window of the nearest requests (0 for all of them). with a
+    //deep queue the seek bound alone lets through every request within one
+    //revolution of the head, which can be thousands 
+    bool rank_by_cost = false;
+    long long rank_window = 64;
+    //the original model, service time is just the distance 
+    bool plain = true;
+
+    //seek and settle time for a move over distance tracks, never more than the
+    //positioning time so its what SSTF uses to stop looking further out 
+    long long seek_time(std::uint32_t distance) const {
+        if (distance == 0) 
+        {
+            return 0;
+        }
+        double time = seek == LINEAR ? track_time * distance
+                    : distance < boundary ? short_base + short_sqrt * std::sqrt(static_cast<double>(distance))
+                    : long_base + long_track * distance;
+        return std::llround(time) + settle;
+    }
+    //seek, settle and then waiting for the sector to come under the head. the
+    //platter turns all the time so where it is only depends on the time 
+    long long positioning_time(std::uint32_t distance, int sector, long long start_time) const {
+        long long time = seek_time(distance);
+        if (rotation > 0 && sectors > 0) 
+        {
+            long long target = ((sector % sectors + sectors) % sectors) * rotation / sectors;
+            long long angle = ((start_time + time) % rotation + rotation) % rotation;
+            time += (target - angle + rotation) % rotation;
+        }
+        return time;
+    }
+    long long service_time(std::uint32_t distance, int sector, int size, long long start_time) const {
+        return positioning_time(distance, sector, start_time) + std::llround(transfer * size);
+    }
+    //loads a device profile, `<key> <value>` lines with # comments. returns an error
+    //message, empty on success 
+    std::string load(const std::string& path) {
+        std::ifstream in(path);
+        if (!in.is_open()) 
+        {
+            return "Error opening file: " + path;
+        }
+        std::string line;
+        std::size_t line_number = 0;
+        while (std::getline(in, line)) {
+            line_number++;
+            std::istringstream iss(line);
+            std::string key, value;
+            if (!(iss >> key) || key[0] == '#') continue;
+            bool ok = static_cast<bool>(iss >> value);
+            if (ok && key == "seek") {
+                ok = value == "linear" || value == "curve";
+                seek = value == "curve" ? CURVE : LINEAR;
+            } else if (ok && key == "rank") {
+                ok = value == "distance" || value == "cost";
+                rank_by_cost = value == "cost";
+            } else if (ok) {
+                char* end = nullptr;
+                double number = strtod(value.c_str(), &end);
+                ok = *end == '\0' && number >= 0;
+                if (key == "track_time") track_time = number;
+                else if (key == "short_base") short_base = number;
+                else if (key == "short_sqrt") short_sqrt = number;
+                else if (key == "long_base") long_base = number;
+                else if (key == "long_track") long_track = number;
+                else if (key == "boundary") boundary = static_cast<long long>(number);
+                else if (key == "settle") settle = static_cast<long long>(number);
+                else if (key == "rotation") rotation = static_cast<long long>(number);
+                else if (key == "sectors") sectors = static_cast<long long>(number);
+                else if (key == "transfer") transfer = number;
+                else if (key == "rank_window") rank_window = static_cast<long long>(number);
+                else ok = false;
+            }
+            if (!ok) 
+            {
+                return "Malformed profile line " + std::to_string(line_number) + ": " + line;
+            }
+        }
+        //SSTF stops at the first seek that is slower than its best candidate, that only
+        //works if a longer seek never takes less time 
+        if (seek == CURVE && boundary > 1 && seek_time(static_cast<std::uint32_t>(boundary - 1)) > seek_time(static_cast<std::uint32_t>(boundary))) 
+        {
+            return "Seek curve of " + path + " gets faster at the boundary";
+        }
+        plain = seek == LINEAR && track_time == 1 && settle == 0 && (rotation == 0 || sectors == 0) && transfer == 0;
+        return "";
+    }
+};
+//what a scheduler can see of the simulation beyond the track it is given, the
+//requests with all their columns and the time, which the simulator sets before
+//every dispatch 
+struct DispatchState {
+    const RequestTable* requests;
+    long long now;
+};
+//fixed size blocks for the node based containers of the schedulers. blocks are cut
+//out of chunks that double in size and only go back to the heap with the pool at the
+//end of the run, a freed block goes on a free list and is the next one handed out.
+//so once a queue has been as long as it gets adding and removing requests doesn't
+//touch the heap anymore 
+class BlockPool {
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+    std::size_t block_size = 0;
+    FreeBlock* free_list = nullptr;
+    std::vector<std::unique_ptr<char[]>> chunks;
+    std::size_t chunk_blocks = 64;
+    static const std::size_t MAX_CHUNK_BLOCKS = 1 << 14;
+    //threads a new chunk onto the free list 
+    void refill() {
+        chunks.emplace_back(new char[chunk_blocks * block_size]);
+        char* chunk = chunks.back().get();
+        for (std::size_t i = chunk_blocks; i-- > 0;) {
+            FreeBlock* block = reinterpret_cast<FreeBlock*>(chunk + i * block_size);
+            block->next = free_list;
+            free_list = block;
+        }
+        chunk_blocks = std::min(chunk_blocks * 2, MAX_CHUNK_BLOCKS);
+    }
+public:
+    BlockPool() = default;
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+    //every block of a pool has the size of the first one asked for 
+    void* allocate(std::size_t size) {
+        if (block_size == 0) 
+        {
+            const std::size_t align = alignof(std::max_align_t);
+            block_size = (std::max(size, sizeof(FreeBlock)) + align - 1) / align * align;
+        }
+        if (free_list == nullptr) 
+        {
+            refill();
+        }
+        FreeBlock* block = free_list;
+        free_list = block->next;
+        return block;
+    }
+    void deallocate(void* pointer) {
+        FreeBlock* block = static_cast<FreeBlock*>(pointer);
+        block->next = free_list;
+        free_list = block;
+    }
+};
+//allocator that gives every container its own BlockPool, copies and rebinds share it
+//so the set nodes all come from the pool of the set that made them. moving a
+//container moves its pool with it which FLOOK relies on when it swaps its queues 
+template <typename T>
+class PoolAllocator {
+public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+    std::shared_ptr<BlockPool> pool;
+
+    PoolAllocator() : pool(std::make_shared<BlockPool>()) {}
+    //no move constructor so a moved from container keeps a pool it can use again 
+    PoolAllocator(const PoolAllocator&) = default;
+    PoolAllocator& operator=(const PoolAllocator&) = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>& other) : pool(other.pool) {}
+    //node containers only ask for one at a time, anything else goes to the heap 
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(n == 1 ? pool->allocate(sizeof(T)) : ::operator new(n * sizeof(T)));
+    }
+    void deallocate(T* pointer, std::size_t n) {
+        if (n == 1) pool->deallocate(pointer);
+        else ::operator delete(pointer);
+    }
+    template <typename U>
+    bool operator==(const PoolAllocator<U>& other) const { return pool == other.pool; }
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>& other) const { return pool != other.pool; }
+};
+//ordered set whose nodes come from its own pool 
+template <typename T>
+using PooledSet = std::set<T, std::less<T>, PoolAllocator<T>>;
+//an ordered set goes into a checkpoint as its size and the gaps between its values 
+template <typename T>
+static void save_set(CheckpointWriter& out, const PooledSet<T>& values) {
+    out.put(static_cast<long long>(values.size()));
+    T previous = 0;
+    for (T value : values) {
+        out.put(static_cast<long long>(value - previous));
+        previous = value;
+    }
+}
+template <typename T>
+static void load_set(CheckpointReader& in, PooledSet<T>& values) {
+    values.clear();
+    std::size_t count = in.get_count();
+    T value = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        value += static_cast<T>(in.get());
+        values.insert(values.end(), value);
+    }
+}
+//takes offset off every value of the set. the order stays the same so the nodes
+//are moved over one by one instead of allocated again 
+template <typename T>
+static void renumber_set(PooledSet<T>& values, T offset) {
+    PooledSet<T> renumbered(values.get_allocator());
+    while (!values.empty()) {
+        auto node = values.extract(values.begin());
+        node.value() -= offset;
+        renumbered.insert(renumbered.end(), std::move(node));
+    }
+    values.swap(renumbered);
+}
+//same for a set ordered by something else first and the id to break ties 
+template <typename T>
+static void renumber_set(PooledSet<std::pair<T, RequestId>>& values, RequestId offset) {
+    PooledSet<std::pair<T, RequestId>> renumbered(values.get_allocator());
+    while (!values.empty()) {
+        auto node = values.extract(values.begin());
+        node.value().second -= offset;
+        renumbered.insert(renumbered.end(), std::move(node));
+    }
+    values.swap(renumbered);
+}
+//base class for the scheduling algorithms. the simulator is instantiated for each
+//concrete (final) scheduler so its calls don't go through the vtable, the base
+//class is still what the benchmarks use to measure the virtual path 
 class IOScheduler {
 public:
     //constructor 
     virtual ~IOScheduler() = default;
-    //2 necessary methods as from intrsuctions one to add request to scheduler 
-    virtual void add_request(IORequest* request) = 0;
-    //the other to get the next request from the scheduler 
-    virtual IORequest* get_next_request(int current_track) = 0;
+    //2 necessary methods as from intrsuctions one to add request to scheduler,
+    //it gets the track along with the id so it never has to look the request up
+    virtual void add_request(RequestId request, int track) = 0;
+    //the other to get the next request from the scheduler, NO_REQUEST if empty 
+    virtual RequestId get_next_request(int current_track) = 0;
+    //asks the scheduler to rank by the service model instead of by track distance,
+    //schedulers that sweep in track order ignore it 
+    virtual void rank_by_model(const ServiceModel* model, const DispatchState* state) {}
+    //called once before the first request for the schedulers that look at more than
+    //the track, like deadlines or streams 
+    virtual void attach(const DispatchState* state) {}
+    //takes a pending request out of the scheduler because it was merged into another
+    //one, returns false if the scheduler can't give it up and it won't be merged 
+    virtual bool remove_request(RequestId request, int track) { return false; }
+    //what the scheduler remembers while nothing is queued, like the direction of a
+    //sweep, as a list of numbers that compare equal when the scheduler would behave
+    //the same from there on. the parallel mode starts pieces of a trace from it 
+    virtual void save_idle(std::vector<long long>& state) const {}
+    virtual void load_idle(const std::vector<long long>& state) {}
+    //everything the scheduler holds, queued requests included, for a checkpoint. load
+    //is called on a new scheduler and leaves it as the saved one was 
+    virtual void save_state(CheckpointWriter& out) const = 0;
+    virtual void load_state(CheckpointReader& in) = 0;
+    //the requests in flight were renumbered (see IOSCHED_RENUMBER_AT), every id the
+    //scheduler holds goes down by offset 
+    virtual void renumber(RequestId offset) = 0;
 };
 
 //subclass that represents the FIFO scheduler
 //derived from scheduler superclass
-class FIFOScheduler : public IOScheduler {
+class FIFOScheduler final : public IOScheduler {
+public:
+    static constexpr char letter = 'N';
 private:
-    //used queue to hold our scheduled io requests 
-    std::queue<IORequest*> io_queue;
+    //used queue to hold our scheduled io requests, a ring that doubles when it is full
+    //instead of a deque that allocates and frees blocks as the queue moves along 
+    std::vector<RequestId> io_queue;
+    std::size_t head = 0;
+    std::size_t tail = 0;
+    //requests merged away while still in the queue, skipped when they come up 
+    PooledSet<RequestId> removed;
 public:
     //trivial add request mehod that just adds the request
     //to our queue
-    void add_request(IORequest* request) override {
-        io_queue.push(request);
+    void add_request(RequestId request, int track) override {
+        if (tail - head == io_queue.size()) {
+            //unroll the ring into one twice as big 
+            std::vector<RequestId> bigger(std::max<std::size_t>(16, 2 * io_queue.size()));
+            for (std::size_t i = head; i != tail; i++) bigger[i - head] = io_queue[i & (io_queue.size() - 1)];
+            tail -= head;
+            head = 0;
+            io_queue.swap(bigger);
+        }
+        io_queue[tail++ & (io_queue.size() - 1)] = request;
     }
 
     //trivial get request method that 
-    IORequest* get_next_request(int current_track) override {
-        //first checks if empty 
-        if (io_queue.empty()) 
+    RequestId get_next_request(int current_track) override {
+        //first checks if empty, merged requests are skipped 
+        while (head != tail) {
+            //if not we get the request using front since fifo and remove request
+            //from queue since now we are processing it  
+            RequestId next_request = io_queue[head++ & (io_queue.size() - 1)];
+            if (removed.empty() || removed.erase(next_request) == 0) 
+            {
+                //return the request
+                return next_request;
+            }
+        }
+        //if it is we return no request
+        return NO_REQUEST;
+    }
+    bool remove_request(RequestId request, int track) override {
+        removed.insert(request);
+        return true;
+    }
+    void save_state(CheckpointWriter& out) const override {
+        out.put(static_cast<long long>(tail - head));
+        for (std::size_t i = head; i != tail; i++) out.put(io_queue[i & (io_queue.size() - 1)]);
+        save_set(out, removed);
+    }
+    void load_state(CheckpointReader& in) override {
+        std::size_t count = in.get_count();
+        for (std::size_t i = 0; i < count; i++) add_request(static_cast<RequestId>(in.get()), 0);
+        load_set(in, removed);
+    }
+    void renumber(RequestId offset) override {
+        for (std::size_t i = head; i != tail; i++) io_queue[i & (io_queue.size() - 1)] -= offset;
+        renumber_set(removed, offset);
+    }
+};
+//ordered index of pending requests shared by the SSTF, LOOK, CLOOK and FLOOK schedulers.
+//every request is a single 64 bit key with the track in the high half (offset so
+//negative tracks sort first) and the id in the low half, so the set is ordered by
+//track and uses the id as the tie breaker when two requests have the same destination
+//track, the same order the LOOK style schedulers used to get by sorting their whole
+//queue on every add. adding and removing a request is O(log n) and nothing in the
+//index points back at the request 
+class TrackIndex {
+private:
+    PooledSet<std::uint64_t> requests;
+public:
+    //what the lookups return when there is no such request 
+    static const std::uint64_t NONE = std::numeric_limits<std::uint64_t>::max();
+    static std::uint64_t key(int track, RequestId id) {
+        return static_cast<std::uint64_t>(static_cast<std::uint32_t>(track) ^ 0x80000000u) << 32 | id;
+    }
+    static int track_of(std::uint64_t key) {
+        return static_cast<int>(static_cast<std::uint32_t>(key >> 32) ^ 0x80000000u);
+    }
+    static RequestId id_of(std::uint64_t key) { return static_cast<RequestId>(key); }
+
+    bool empty() const { return requests.empty(); }
+    std::size_t size() const { return requests.size(); }
+    void insert(RequestId request, int track) { requests.insert(key(track, request)); }
+    //returns whether the request was there 
+    bool erase(std::uint64_t request) { return requests.erase(request) != 0; }
+    bool contains(std::uint64_t request) const { return requests.count(request) != 0; }
+    //closest request with track >= the given track, on a tie the lowest id 
+    std::uint64_t at_or_above(int track) const {
+        auto it = requests.lower_bound(key(track, 0));
+        return it == requests.end() ? NONE : *it;
+    }
+    //closest request with track <= the given track, on a tie the lowest id.
+    //the element right before upper_bound is the highest id on that track so
+    //we have to look up the first one on that track again
+    std::uint64_t at_or_below(int track) const {
+        auto it = requests.upper_bound(key(track, NO_REQUEST));
+        if (it == requests.begin()) 
         {
-            //if it is we return null
-            return nullptr;
+            return NONE;
+        }
+        --it;
+        return *requests.lower_bound(key(track_of(*it), 0));
+    }
+    //neighbours of a key in index order, for walking outwards from the head 
+    std::uint64_t after(std::uint64_t request) const {
+        auto it = requests.upper_bound(request);
+        return it == requests.end() ? NONE : *it;
+    }
+    std::uint64_t before(std::uint64_t request) const {
+        auto it = requests.lower_bound(request);
+        return it == requests.begin() ? NONE : *--it;
+    }
+    //request on the lowest track with the lowest id 
+    std::uint64_t lowest() const {
+        return requests.empty() ? NONE : *requests.begin();
+    }
+    void save(CheckpointWriter& out) const { save_set(out, requests); }
+    void load(CheckpointReader& in) { load_set(in, requests); }
+    //the id is the low half of the key and never below offset, so this only changes the id 
+    void renumber(RequestId offset) { renumber_set(requests, static_cast<std::uint64_t>(offset)); }
+};
+//which requests a scan over a flat queue may pick 
+enum ScanDirection { SCAN_UP, SCAN_DOWN, SCAN_ANY };
+//a scan kernel returns the position of the closest request to current_track among
+//tracks[0..count) that passes the direction filter (track >= current_track for up,
+//<= for down), the lowest id when several are the same distance away, or count if
+//no request qualifies. that is the same choice the directional loops in LOOK and
+//FLOOK made before they moved to the track index 
+typedef std::size_t (*ScanKernel)(const int* tracks, const RequestId* ids, std::size_t count, int current_track, ScanDirection direction);
+
+//plain loop, used on cpus without sse4.1 and for the tail of the vector kernels 
+static std::size_t scan_closest_scalar(const int* tracks, const RequestId* ids, std::size_t count, int current_track, ScanDirection direction) {
+    std::size_t best = count;
+    std::uint32_t best_distance = std::numeric_limits<std::uint32_t>::max();
+    RequestId best_id = NO_REQUEST;
+    for (std::size_t i = 0; i < count; i++) {
+        if ((direction == SCAN_UP && tracks[i] < current_track) || (direction == SCAN_DOWN && tracks[i] > current_track)) continue;
+        //distance as unsigned so even the extreme int tracks can't overflow 
+        std::uint32_t distance = tracks[i] >= current_track ? static_cast<std::uint32_t>(tracks[i]) - static_cast<std::uint32_t>(current_track)
+                                                            : static_cast<std::uint32_t>(current_track) - static_cast<std::uint32_t>(tracks[i]);
+        if (distance < best_distance || (distance == best_distance && ids[i] < best_id)) {
+            best = i;
+            best_distance = distance;
+            best_id = ids[i];
+        }
+    }
+    return best;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+//the vector kernels keep a best distance, id and position per lane in one pass and
+//reduce the lanes at the end. lanes that don't pass the filter get distance and id
+//0xffffffff, no real request has that id so a real candidate always beats them 
+//LEAVE runs once the vectors are stored, the avx2 kernel clears the upper halves there
+//because gcc doesn't always do it before the call into the scalar tail and every sse
+//instruction after that in the rest of the program got slower 
+#define IOSCHED_SCAN_KERNEL(NAME, TARGET, VEC, WIDTH, SET1, LOAD, STORE, ADD, SUB, CMPGT, CMPEQ, AND, OR, ANDNOT, XOR, BLEND, LEAVE) \
+__attribute__((target(TARGET))) \
+static std::size_t NAME(const int* tracks, const RequestId* ids, std::size_t count, int current_track, ScanDirection direction) { \
+    const VEC ones = SET1(-1); \
+    const VEC sign = SET1(static_cast<int>(0x80000000u)); \
+    const VEC current = SET1(current_track); \
+    const VEC want_above = direction == SCAN_DOWN ? SET1(0) : ones; \
+    const VEC want_below = direction == SCAN_UP ? SET1(0) : ones; \
+    VEC best_distance = ones, best_id = ones, best_position = ones; \
+    VEC position = SET1(0); \
+    { \
+        alignas(32) int lanes[WIDTH]; \
+        for (int lane = 0; lane < WIDTH; lane++) lanes[lane] = lane; \
+        position = LOAD(reinterpret_cast<const VEC*>(lanes)); \
+    } \
+    const VEC step = SET1(WIDTH); \
+    std::size_t i = 0; \
+    for (; i + WIDTH <= count; i += WIDTH) { \
+        VEC track = LOAD(reinterpret_cast<const VEC*>(tracks + i)); \
+        VEC id = LOAD(reinterpret_cast<const VEC*>(ids + i)); \
+        VEC above = CMPGT(track, current); \
+        VEC below = CMPGT(current, track); \
+        VEC at_or_above = ANDNOT(below, ones); \
+        VEC at_or_below = ANDNOT(above, ones); \
+        VEC valid = OR(AND(at_or_above, want_above), AND(at_or_below, want_below)); \
+        VEC distance = BLEND(SUB(current, track), SUB(track, current), at_or_above); \
+        distance = OR(distance, ANDNOT(valid, ones)); \
+        id = OR(id, ANDNOT(valid, ones)); \
+        /* unsigned compares by flipping the sign bit */ \
+        VEC closer = CMPGT(XOR(best_distance, sign), XOR(distance, sign)); \
+        VEC same = CMPEQ(distance, best_distance); \
+        VEC lower_id = CMPGT(XOR(best_id, sign), XOR(id, sign)); \
+        VEC better = OR(closer, AND(same, lower_id)); \
+        best_distance = BLEND(best_distance, distance, better); \
+        best_id = BLEND(best_id, id, better); \
+        best_position = BLEND(best_position, position, better); \
+        position = ADD(position, step); \
+    } \
+    alignas(32) std::uint32_t lane_distance[WIDTH], lane_id[WIDTH], lane_position[WIDTH]; \
+    STORE(reinterpret_cast<VEC*>(lane_distance), best_distance); \
+    STORE(reinterpret_cast<VEC*>(lane_id), best_id); \
+    STORE(reinterpret_cast<VEC*>(lane_position), best_position); \
+    LEAVE; \
+    std::size_t best = count; \
+    std::uint32_t distance = std::numeric_limits<std::uint32_t>::max(); \
+    RequestId id = NO_REQUEST; \
+    for (int lane = 0; lane < WIDTH; lane++) { \
+        if (lane_id[lane] == NO_REQUEST) continue; \
+        if (lane_distance[lane] < distance || (lane_distance[lane] == distance && lane_id[lane] < id)) { \
+            best = lane_position[lane]; \
+            distance = lane_distance[lane]; \
+            id = lane_id[lane]; \
+        } \
+    } \
+    std::size_t tail = i + scan_closest_scalar(tracks + i, ids + i, count - i, current_track, direction); \
+    if (tail < count) { \
+        std::uint32_t tail_distance = tracks[tail] >= current_track ? static_cast<std::uint32_t>(tracks[tail]) - static_cast<std::uint32_t>(current_track) \
+                                                                    : static_cast<std::uint32_t>(current_track) - static_cast<std::uint32_t>(tracks[tail]); \
+        if (tail_distance < distance || (tail_distance == distance && ids[tail] < id)) best = tail; \
+    } \
+    return best; \
+}
+
+IOSCHED_SCAN_KERNEL(scan_closest_sse41, "sse4.1", __m128i, 4, _mm_set1_epi32, _mm_loadu_si128, _mm_store_si128,
+                    _mm_add_epi32, _mm_sub_epi32, _mm_cmpgt_epi32, _mm_cmpeq_epi32, _mm_and_si128, _mm_or_si128,
+                    _mm_andnot_si128, _mm_xor_si128, _mm_blendv_epi8, (void)0)
+IOSCHED_SCAN_KERNEL(scan_closest_avx2, "avx2", __m256i, 8, _mm256_set1_epi32, _mm256_loadu_si256, _mm256_store_si256,
+                    _mm256_add_epi32, _mm256_sub_epi32, _mm256_cmpgt_epi32, _mm256_cmpeq_epi32, _mm256_and_si256, _mm256_or_si256,
+                    _mm256_andnot_si256, _mm256_xor_si256, _mm256_blendv_epi8, _mm256_zeroupper())
+#undef IOSCHED_SCAN_KERNEL
+#endif
+
+//picks the widest kernel the cpu we are running on supports, once at startup 
+static ScanKernel select_scan_kernel() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return scan_closest_avx2;
+    if (__builtin_cpu_supports("sse4.1")) return scan_closest_sse41;
+#endif
+    return scan_closest_scalar;
+}
+static const ScanKernel scan_closest = select_scan_kernel();
+
+//pending requests for LOOK and FLOOK. while the queue is short the requests sit
+//unordered in two flat arrays (tracks and ids) and a dispatch is one vectorized scan,
+//adding is a push_back and removing swaps in the last element. once the queue gets
+//longer than FLAT_LIMIT a scan costs more than walking the tree so everything moves
+//into a TrackIndex, and back to the arrays when it has drained to a quarter of that.
+//lookups return the same keys as TrackIndex either way 
+class AdaptiveTrackQueue {
+private:
+    std::vector<int> tracks;
+    std::vector<RequestId> ids;
+    TrackIndex index;
+    bool indexed = false;
+    //position of the last request a flat lookup returned, the dispatch that follows
+    //removes exactly that one so it doesn't have to be searched for 
+    std::size_t last_position = 0;
+
+    std::uint64_t flat_lookup(int track, ScanDirection direction) {
+        std::size_t position = scan_closest(tracks.data(), ids.data(), tracks.size(), track, direction);
+        if (position == tracks.size()) 
+        {
+            return TrackIndex::NONE;
+        }
+        last_position = position;
+        return TrackIndex::key(tracks[position], ids[position]);
+    }
+public:
+    //queues up to this long are scanned, see bench/scan_bench for where the tree wins 
+    static const std::size_t FLAT_LIMIT = 256;
+
+    bool empty() const { return indexed ? index.empty() : tracks.empty(); }
+    std::size_t size() const { return indexed ? index.size() : tracks.size(); }
+    void insert(RequestId request, int track) {
+        if (indexed) {
+            index.insert(request, track);
+            return;
+        }
+        tracks.push_back(track);
+        ids.push_back(request);
+        if (tracks.size() > FLAT_LIMIT) {
+            for (std::size_t i = 0; i < tracks.size(); i++) index.insert(ids[i], tracks[i]);
+            tracks.clear();
+            ids.clear();
+            indexed = true;
+        }
+    }
+    void erase(std::uint64_t request) {
+        if (indexed) {
+            index.erase(request);
+            if (index.size() < FLAT_LIMIT / 4) {
+                //walk the tree in order, any order is fine for the arrays 
+                for (std::uint64_t key = index.lowest(); key != TrackIndex::NONE; key = index.lowest()) {
+                    tracks.push_back(TrackIndex::track_of(key));
+                    ids.push_back(TrackIndex::id_of(key));
+                    index.erase(key);
+                }
+                indexed = false;
+            }
+            return;
+        }
+        RequestId id = TrackIndex::id_of(request);
+        std::size_t position = last_position;
+        if (position >= ids.size() || ids[position] != id) {
+            position = std::find(ids.begin(), ids.end(), id) - ids.begin();
+        }
+        tracks[position] = tracks.back();
+        ids[position] = ids.back();
+        tracks.pop_back();
+        ids.pop_back();
+    }
+    //erases the request if it is queued, returns whether it was 
+    bool remove(RequestId request, int track) {
+        std::uint64_t key = TrackIndex::key(track, request);
+        if (indexed ? !index.contains(key) : (last_position = std::find(ids.begin(), ids.end(), request) - ids.begin()) == ids.size()) 
+        {
+            return false;
+        }
+        erase(key);
+        return true;
+    }
+    //the arrays are saved in their order and the index as it is, so a loaded queue
+    //is kept the same way as the saved one 
+    void save(CheckpointWriter& out) const {
+        out.put(indexed);
+        if (indexed) {
+            index.save(out);
+            return;
+        }
+        out.put(static_cast<long long>(tracks.size()));
+        for (std::size_t i = 0; i < tracks.size(); i++) {
+            out.put(tracks[i]);
+            out.put(ids[i]);
+        }
+    }
+    void load(CheckpointReader& in) {
+        indexed = in.get() != 0;
+        if (indexed) {
+            index.load(in);
+            return;
+        }
+        std::size_t count = in.get_count();
+        for (std::size_t i = 0; i < count; i++) {
+            tracks.push_back(static_cast<int>(in.get()));
+            ids.push_back(static_cast<RequestId>(in.get()));
         }
-        //if not we get the request using front since fifo
-        IORequest* next_request = io_queue.front();
-        //remove request from queue since now we are processing it  
-        io_queue.pop();
-        //return the request
-        return next_request;
+    }
+    void renumber(RequestId offset) {
+        index.renumber(offset);
+        for (RequestId& id : ids) id -= offset;
+    }
+    //closest request with track >= the given track, on a tie the lowest id 
+    std::uint64_t at_or_above(int track) {
+        return indexed ? index.at_or_above(track) : flat_lookup(track, SCAN_UP);
+    }
+    //closest request with track <= the given track, on a tie the lowest id 
+    std::uint64_t at_or_below(int track) {
+        return indexed ? index.at_or_below(track) : flat_lookup(track, SCAN_DOWN);
     }
 };
 //subcalss that represents the SSTF scheduler 
 //derived from superclass IOscheduler 
-class SSTFScheduler : public IOScheduler {
+class SSTFScheduler final : public IOScheduler {
+public:
+    static constexpr char letter = 'S';
 private:
-    //using dequeu to hold our scheduled requests
-    std::deque<IORequest*> io_queue;
+    //pending requests ordered by track then id so the closest request on either
+    //side of the head can be found in O(log n) instead of scanning every request
+    TrackIndex io_queue;
+    //set when ranking by modeled positioning time 
+    const ServiceModel* model = nullptr;
+    const DispatchState* state = nullptr;
+    //walks outwards from the head taking the nearer side first and keeps the request
+    //with the lowest positioning time, nearer and then lower id on a tie. the seek
+    //alone never costs more than the whole positioning, so once the next candidate's
+    //seek is slower than the best one nothing further out can win. the walk also ends
+    //after the models rank window 
+    RequestId next_by_cost(int current_track) {
+        std::uint64_t above = io_queue.at_or_above(current_track);
+        std::uint64_t below = io_queue.before(TrackIndex::key(current_track, 0));
+        std::uint64_t best = TrackIndex::NONE;
+        long long best_cost = 0;
+        std::uint32_t best_distance = 0;
+        long long left = model->rank_window > 0 ? model->rank_window : -1;
+        while ((above != TrackIndex::NONE || below != TrackIndex::NONE) && left-- != 0) {
+            std::uint32_t above_distance = above == TrackIndex::NONE ? 0 : static_cast<std::uint32_t>(TrackIndex::track_of(above)) - static_cast<std::uint32_t>(current_track);
+            std::uint32_t below_distance = below == TrackIndex::NONE ? 0 : static_cast<std::uint32_t>(current_track) - static_cast<std::uint32_t>(TrackIndex::track_of(below));
+            bool take_above = below == TrackIndex::NONE || (above != TrackIndex::NONE && above_distance <= below_distance);
+            std::uint64_t candidate = take_above ? above : below;
+            std::uint32_t distance = take_above ? above_distance : below_distance;
+            if (best != TrackIndex::NONE && model->seek_time(distance) > best_cost) break;
+            RequestId id = TrackIndex::id_of(candidate);
+            long long cost = model->positioning_time(distance, state->requests->sector(id), state->now);
+            if (best == TrackIndex::NONE || cost < best_cost || (cost == best_cost && (distance < best_distance || (distance == best_distance && id < TrackIndex::id_of(best))))) 
+            {
+                best = candidate;
+                best_cost = cost;
+                best_distance = distance;
+            }
+            if (take_above) above = io_queue.after(above);
+            else below = io_queue.before(below);
+        }
+        io_queue.erase(best);
+        return TrackIndex::id_of(best);
+    }
 public:
-    //again pretty trivial add method to add a request to the dequeue
-    void add_request(IORequest* request) override {
-        io_queue.push_back(request);
+    //again pretty trivial add method to add a request to the index
+    void add_request(RequestId request, int track) override {
+        io_queue.insert(request, track);
     }
+    void rank_by_model(const ServiceModel* service_model, const DispatchState* dispatch) override {
+        model = service_model;
+        state = dispatch;
+    }
+    //merged requests just leave the index 
+    bool remove_request(RequestId request, int track) override {
+        return io_queue.erase(TrackIndex::key(track, request));
+    }
+    void save_state(CheckpointWriter& out) const override { io_queue.save(out); }
+    void load_state(CheckpointReader& in) override { io_queue.load(in); }
+    void renumber(RequestId offset) override { io_queue.renumber(offset); }
     //gets the next request from our scheduler 
-    IORequest* get_next_request(int current_track) override {
+    RequestId get_next_request(int current_track) override {
         //first checks if empty and if so returns null
         if (io_queue.empty()) 
         {
-            return nullptr;
-        }
-        //if not empty we find the request that is closest to the current track
-        //regardless of direction 
-        auto closest_it = std::min_element(io_queue.begin(), io_queue.end(),
-                                           [current_track](IORequest* a, IORequest* b) {
-                                               return std::abs(a->track - current_track) < std::abs(b->track - current_track);
-                                           });
-        //get that request in another variable so we can erase it from the queue
-        IORequest* next_request = *closest_it;
-        io_queue.erase(closest_it);
+            return NO_REQUEST;
+        }
+        if (model != nullptr) 
+        {
+            return next_by_cost(current_track);
+        }
+        //the closest request is either the nearest one at or above the current track
+        //or the nearest one at or below it, regardless of direction 
+        std::uint64_t above = io_queue.at_or_above(current_track);
+        std::uint64_t below = io_queue.at_or_below(current_track);
+        std::uint64_t next_request = above != TrackIndex::NONE ? above : below;
+        //if both sides have a candidate pick the closer one, when they are the same
+        //distance away the one that arrived first (lower id) wins just like the old
+        //scan over the queue in arrival order did
+        if (above != TrackIndex::NONE && below != TrackIndex::NONE) 
+        {
+            long long above_distance = static_cast<long long>(TrackIndex::track_of(above)) - current_track;
+            long long below_distance = static_cast<long long>(current_track) - TrackIndex::track_of(below);
+            if (below_distance < above_distance || (below_distance == above_distance && TrackIndex::id_of(below) < TrackIndex::id_of(above))) 
+            {
+                next_request = below;
+            }
+        }
+        io_queue.erase(next_request);
         //return the request
-        return next_request;
+        return TrackIndex::id_of(next_request);
     }
 };
 //subclass that represents LOOK scheduler
 //derived from scheduler superclass
-class LOOKScheduler : public IOScheduler {
+class LOOKScheduler final : public IOScheduler {
+public:
+    static constexpr char letter = 'L';
 private:
-    //uses dequeue to hold the scheduled requests 
-    std::deque<IORequest*> io_queue;
+    //pending requests, scanned while there are few and ordered by track then id when there are many 
+    AdaptiveTrackQueue io_queue;
     //variable to keep track of direction we are currently
     //moving the head in and as mentioned in isntructiosn
     //we always move up first so intialized to 1
     int direction=1;
 public:
-    //add requests to the dequeue 
-    void add_request(IORequest* request) override {
-        io_queue.push_back(request);
-        //an additional step i took was to keep it sorted based on id else base on track
-        //since i realized there were scenarios were requests may have same destination track
-        //so to choose the one to go first should be based on id. 
-        std::sort(io_queue.begin(), io_queue.end(), [](IORequest* a, IORequest* b) {
-            if (a->track == b->track) 
-            {
-                return a->id < b->id; 
-            }
-            return a->track < b->track;
-        });
+    //add requests to the index, it keeps them ordered by track and by id for
+    //requests that have the same destination track 
+    void add_request(RequestId request, int track) override {
+        io_queue.insert(request, track);
+    }
+    bool remove_request(RequestId request, int track) override {
+        return io_queue.remove(request, track);
+    }
+    void save_idle(std::vector<long long>& state) const override {
+        state.push_back(direction);
+    }
+    void load_idle(const std::vector<long long>& state) override {
+        direction = static_cast<int>(state[0]);
     }
-    //gets the next request from the dequeue 
-   IORequest* get_next_request(int current_track) override {
+    void save_state(CheckpointWriter& out) const override {
+        io_queue.save(out);
+        out.put(direction);
+    }
+    void load_state(CheckpointReader& in) override {
+        io_queue.load(in);
+        direction = static_cast<int>(in.get());
+    }
+    void renumber(RequestId offset) override { io_queue.renumber(offset); }
+    //gets the next request from the index 
+    RequestId get_next_request(int current_track) override {
         //first checks if are queue is empty and if so returns a null ptr
         if (io_queue.empty())
         { 
-            return nullptr; 
-        }
-        //variable to hold our next request 
-        IORequest* next_request = nullptr;
-        //vairable to keep track of the minimum distance we have seen a request
-        //needs to travel from the current track 
-        int min_distance = std::numeric_limits<int>::max();
-        //variable used to keep track of the id as well since if two are same distance
-        //away from current track then id should be used as tie breaker 
-        int best_id = std::numeric_limits<int>::max();
-        //helper variable to see if we found a request to return sicne if not must 
-        //reverse directions 
-        bool found_request = false;
-        //if we are moving up intially 
+            return NO_REQUEST; 
+        }
+        std::uint64_t next_request = TrackIndex::NONE;
+        //if we are moving up the closest request is the first one at or above the
+        //current track, if there is none we reverse and take the closest one below 
         if (direction == 1) {
-            //loop through the queue
-            for (auto it = io_queue.begin(); it != io_queue.end(); ++it) {
-                //check if the requests from queue has track greater or equal to current track
-                //since right now we are only moving up 
-                if ((*it)->track >= current_track) {
-                    //if so calculate distance 
-                    int dist = std::abs((*it)->track - current_track);
-                    //if we have found a lower distance movement for a request or we found one
-                    //that is equal to the min we have seeen so far check if its id is less than 
-                    //the one we have seen so far
-                    if (dist < min_distance || (dist == min_distance && (*it)->id < best_id)) {
-                        //if so we assign next request return vairable to that request from the queue
-                        next_request = *it;
-                        //assign min distance for comparisons in later iterations 
-                        min_distance = dist;
-                        //assign our best id similarlry. 
-                        best_id = (*it)->id;
-                        //we have found a request so need need to check other direction
-                        found_request = true;
-                    }
-                }
-            }
-            //if we haven't found request then we must start moving down 
-            if (!found_request) {
-                //so now we move down so direction is changed for reference in all further calls of this
-                //method or iterations 
+            next_request = io_queue.at_or_above(current_track);
+            if (next_request == TrackIndex::NONE) {
                 direction = -1;
-                //loop through queue again similarly 
-                for (auto it = io_queue.begin(); it != io_queue.end(); ++it) {
-                    //calculate distnace using absolute value since now we are moving down
-                    //from current track 
-                    int dist = std::abs((*it)->track - current_track);
-                    //pretty much same comparison check if we have found a request whose track 
-                    //is closer to current track or its same distance as a minimum we have found before
-                    //but higher priopritized id 
-                    if (dist < min_distance || (dist == min_distance && (*it)->id < best_id)) {
-                        //set our return varaible
-                        next_request = *it;
-                        //set our distance helper for further iterations 
-                        min_distance = dist;
-                        //set our id helper for further iterations
-                        best_id = (*it)->id;
-                    }
-                }
-            }
-            //if our intial direction was down not up from the last call of this method 
-        } else if (direction == -1) {
-            //loop through queue again similarly 
-            for (auto it = io_queue.begin(); it != io_queue.end(); ++it) {
-                //now checking if request has track less than or equal to current track
-                if ((*it)->track <= current_track) {
-                    //get distance from current track 
-                    int dist = std::abs((*it)->track - current_track);
-                    //if our distance is smaller than min seen so far or its the same but id of
-                    //this request is higher priority 
-                    if (dist < min_distance || (dist == min_distance && (*it)->id < best_id)) {
-                        //assign our return variable 
-                        next_request = *it;
-                        //assign distance helper for future iterations 
-                        min_distance = dist;
-                        //assign ide helper for future iterations 
-                        best_id = (*it)->id;
-                        //we found a request moving down so no need to reverse directions 
-                        found_request = true;
-                    }
-                }
+                next_request = io_queue.at_or_below(current_track);
             }
-            //if we weren't able to find one from our intial move down 
-            if (!found_request) {
-                //change direction to up for future iterations and calls
-                //of this method 
+        //if we are moving down its the same thing mirrored 
+        } else {
+            next_request = io_queue.at_or_below(current_track);
+            if (next_request == TrackIndex::NONE) {
                 direction = 1;
-                //loop through queue 
-                for (auto it = io_queue.begin(); it != io_queue.end(); ++it) {
-                    //calculate distance from current track 
-                    int dist = std::abs((*it)->track - current_track);
-                    //again if distance is less than min seen so far or id has higher priority 
-                    if (dist < min_distance || (dist == min_distance && (*it)->id < best_id)) {
-                        //set our return variable 
-                        next_request = *it;
-                        //set our distance helper for next iterations 
-                        min_distance = dist;
-                        //set our id helper for next iterations 
-                        best_id = (*it)->id;
-                    }
-                }
+                next_request = io_queue.at_or_above(current_track);
             }
         }
         //remove request from queue 
-        io_queue.erase(std::remove(io_queue.begin(), io_queue.end(), next_request), io_queue.end());
+        io_queue.erase(next_request);
         //return requests
-        return next_request;
+        return TrackIndex::id_of(next_request);
     }
-  
-
 };
 //subclass that represents the CLOOK scheduler
 //derived from IOscheduler superclass
-class CLOOKScheduler : public IOScheduler {
+class CLOOKScheduler final : public IOScheduler {
+public:
+    static constexpr char letter = 'C';
 private:
-    //used dequeu to hold scheduled requests 
-    std::deque<IORequest*> io_queue;
+    //pending requests ordered by track then id 
+    TrackIndex io_queue;
 public:
     //add requests to the scheduler 
-    void add_request(IORequest* request) override {
-        io_queue.push_back(request);
-        //i have this sort as previous in the LOOK algorithm due to a problem as I was facing
-        //when two requests were same distance away from current track or 2 requests have same destination
-        //track id should be tie breaker 
-        std::sort(io_queue.begin(), io_queue.end(), [](IORequest* a, IORequest* b) {
-             if (a->track == b->track) 
-            {
-                return a->id < b->id; 
-            }
-            return a->track < b->track;
-        });
+    void add_request(RequestId request, int track) override {
+        io_queue.insert(request, track);
     }
+    bool remove_request(RequestId request, int track) override {
+        return io_queue.erase(TrackIndex::key(track, request));
+    }
+    void save_state(CheckpointWriter& out) const override { io_queue.save(out); }
+    void load_state(CheckpointReader& in) override { io_queue.load(in); }
+    void renumber(RequestId offset) override { io_queue.renumber(offset); }
     //gets the next requests 
-    IORequest* get_next_request(int current_track) override {
+    RequestId get_next_request(int current_track) override {
         //first check if queue is empty and if so reutrns null ptr 
         if (io_queue.empty()) 
             {
-                return nullptr;
-            }
-        //goes through queue and finds the first requests is greater than or equal to current track 
-        auto it = std::find_if(io_queue.begin(), io_queue.end(), [current_track](IORequest* r) { return r->track >= current_track; });
-        //if none found the request to be returned is just the requests at start of queue 
-        if (it == io_queue.end()) it = io_queue.begin(); 
-        //set our return variable 
-        IORequest* next_request = *it;
+                return NO_REQUEST;
+            }
+        //first request whose track is greater than or equal to current track 
+        std::uint64_t next_request = io_queue.at_or_above(current_track);
+        //if none found we wrap around to the lowest track 
+        if (next_request == TrackIndex::NONE) next_request = io_queue.lowest(); 
         //remove requests from queue 
-        io_queue.erase(it);
+        io_queue.erase(next_request);
         //return requests
-        return next_request;
+        return TrackIndex::id_of(next_request);
     }
 };
 //subclass that represents the FLOOk scheduler dereived from
 //super class IOscheduler 
-class FLOOKScheduler : public IOScheduler {
+class FLOOKScheduler final : public IOScheduler {
+public:
+    static constexpr char letter = 'F';
 private:
     //now use 2 queues as mentioned in the instructions
     //io_queue represents the active queueu
-    std::deque<IORequest*> io_queue;
+    AdaptiveTrackQueue io_queue;
     //and add queue is same as what was in the instructions 
-    std::deque<IORequest*> add_queue;
+    AdaptiveTrackQueue add_queue;
     //helper to keep track of direction to move head in always starts
     //by moving up so intailized to 1 
     int direction = 1; 
 public:
     //add method that adds it but it actually adds it to the add_queue
     //not to the io_queue(active_queue)
-    void add_request(IORequest* request) override {
-        add_queue.push_back(request);
-        //again using sort due to problems i was running into as mentioned with
-        //the LOOK and CLOOK scheduler 
-        std::sort(add_queue.begin(), add_queue.end(), [](IORequest* a, IORequest* b) {
-            if (a->track == b->track) 
-            {
-                return a->id < b->id; 
-            }
-            return a->track < b->track;
-        });
+    void add_request(RequestId request, int track) override {
+        add_queue.insert(request, track);
+    }
+    //the request can be in either queue 
+    bool remove_request(RequestId request, int track) override {
+        return io_queue.remove(request, track) || add_queue.remove(request, track);
+    }
+    //which of the two queues is the active one matters, so they keep their roles 
+    void save_state(CheckpointWriter& out) const override {
+        io_queue.save(out);
+        add_queue.save(out);
+        out.put(direction);
+    }
+    void load_state(CheckpointReader& in) override {
+        io_queue.load(in);
+        add_queue.load(in);
+        direction = static_cast<int>(in.get());
+    }
+    void renumber(RequestId offset) override {
+        io_queue.renumber(offset);
+        add_queue.renumber(offset);
     }
     //gets the next requests 
-    IORequest* get_next_request(int current_track) override {
+    RequestId get_next_request(int current_track) override {
         //first checks if io_queue is empty since we may need to swap 
         if (io_queue.empty()) 
         {
             //if so before swapping we check if add_queue is empty 
             if (add_queue.empty()) 
                 {
-                    //if so we reutnr null 
-                    return nullptr;
+                    //if so we reutnr no request 
+                    return NO_REQUEST;
                 }
             //if add is not empty that mneans more request have been scheduled 
             //so swap add and io(active)queue. 
             std::swap(io_queue, add_queue);
         }
-        //helper variable declaration/intiailization
-        //return variable that holds request
-        IORequest* next_request = nullptr;
-        //tracker varaible to hold min distanc we have seen so far 
-        int min_distance = std::numeric_limits<int>::max();
-        //tracker variable to hold id of the min distance we have seen so far
-        int best_id = std::numeric_limits<int>::max();
-        //bool indicator to see if we have found requets moving up 
-        bool found_request = false;
         //the main difference between this and LOOk is that for FLOOK the intial direction
         //is always going up from the current track it can never be going down
         //we only go down from current track if we couln't find a request while going up 
-        //so loop through queue as we have been ding 
-        for (auto it = io_queue.begin(); it != io_queue.end(); ++it) 
-        {
-            //check that request track is greater than the current since moving up 
-            if ((*it)->track >= current_track) 
-            {
-                //if so get the distance 
-                int dist = std::abs((*it)->track - current_track);
-                //if the distance is less than min we have seen 
-                //or its the same but id of this request has higher priority 
-                if (dist < min_distance || (dist == min_distance && (*it)->id < best_id)) 
-                {
-                    //set our return variable 
-                    next_request = *it;
-                    //set our distarnce tracker for future iterations
-                    min_distance = dist;
-                    //set our id tracker for future iterations
-                    best_id = (*it)->id;
-                    //set ou boolean since now we don't have to try and move down
-                    found_request = true;
-                }
-            }
-        }
+        std::uint64_t next_request = io_queue.at_or_above(current_track);
         //if we were not able to find a request moving up now we move down 
-        if (!found_request) {
+        if (next_request == TrackIndex::NONE) {
             //no need to do this really since we alawys move up first then move down
             //with FLOOK but i just added it for consistency
             direction = -1;
-            //loop through queue 
-            for (auto it = io_queue.begin(); it != io_queue.end(); ++it) 
-            {
-                //calculate distance 
-                int dist = std::abs((*it)->track - current_track);
-                //if distance is less than min seen so far or id has higher priotiy 
-                if (dist < min_distance || (dist == min_distance && (*it)->id < best_id)) 
-                {
-                    //set our return varaible
-                    next_request = *it;
-                    //set our min distance tracker for future iteration
-                    min_distance = dist;
-                    //set our id tracker for future iterations 
-                    best_id = (*it)->id;
-                }
-            }
+            next_request = io_queue.at_or_below(current_track);
         }
         //remove requesut from queue 
-        io_queue.erase(std::remove(io_queue.begin(), io_queue.end(), next_request), io_queue.end());
+        io_queue.erase(next_request);
         //return requests from queue
-        return next_request;
+        return TrackIndex::id_of(next_request);
         
     }
 };
-
-void simulate_io_scheduler(IOScheduler& scheduler, const std::vector<IORequest>& requests, bool verbose = false) {
-    //helper variable declaration/intialization
-    //list to hold our completed requests 
-    //many of these used for output 
-    std::vector<IORequest> completed_requests;
-    //track variable to keep track of current_time 
-    int current_time = 0;
-    //track variable to keep track of current request
-    int current_track = 0;
-    //track variable to keep track of active request
-    IORequest* active_request = nullptr;
-    //index variable for accessing our list of requests that was intiailzied when reading
-    //the input file 
-    std::size_t request_index = 0;
-    //track variable to keep track of total movement of disk head 
-    int total_movement = 0;
-    //here i essentially tried to follow the pseudocode given in the directions
-    //as close as possible to make it simpler 
-    //while we have not gone through all requests essentially since thats the only
-    //time we will break out of the loop
-    while (true) {
-        //loop through are requests list and see if any have arrived at current time 
-        while (request_index < requests.size() && requests[request_index].arrival_time == current_time) 
+//subclass modelled on the linux mq-deadline scheduler. reads and writes are kept
+//apart, each sorted by track for dispatch and in arrival order for the deadlines.
+//a batch serves up to FIFO_BATCH requests of one direction going up from the head,
+//reads are preferred unless writes were passed over WRITES_STARVED times in a row,
+//and a new batch starts at the oldest request if that one is past its deadline or
+//there is nothing left above the head. every step is O(log n) 
+class DeadlineScheduler final : public IOScheduler {
+public:
+    static constexpr char letter = 'D';
+    //the linux defaults reading one time unit as a millisecond 
+    static constexpr int READ_EXPIRE = 500;
+    static constexpr int WRITE_EXPIRE = 5000;
+    static constexpr int FIFO_BATCH = 16;
+    static constexpr int WRITES_STARVED = 2;
+private:
+    const DispatchState* state = nullptr;
+    //reads at 0 and writes at 1 
+    TrackIndex sorted[2];
+    //requests of a direction by (arrival time, id). an unsorted input can add a request
+    //after later arrivals so the id alone isn't the arrival order. with one expiry per
+    //direction the first one is also the first to pass its deadline 
+    PooledSet<std::pair<long long, RequestId>> fifo[2];
+    int batch_direction = 0;
+    int batching = 0;
+    int starved = 0;
+    bool expired(int direction) const {
+        if (fifo[direction].empty()) 
         {
-            //if they have arrived add it to scheduler to get it ready to be scheduled 
-            scheduler.add_request(const_cast<IORequest*>(&requests[request_index]));
-            //increment our request index to check if next have arrived or not 
-            request_index++;
+            return false;
         }
-
-        //if we have an active request that is now completed after incrementing current time
-        if (active_request && active_request->end_time == current_time) 
-        {
-            //then since its done add it to our list of comeplete requests 
-            completed_requests.push_back(*active_request);
-            //assign it to null ptr since now no active request so must get a new one 
-            active_request = nullptr;
-
+        return state->now >= fifo[direction].begin()->first + (direction ? WRITE_EXPIRE : READ_EXPIRE);
+    }
+    RequestId take(int direction, std::uint64_t request) {
+        sorted[direction].erase(request);
+        fifo[direction].erase({state->requests->arrival_time(TrackIndex::id_of(request)), TrackIndex::id_of(request)});
+        batching++;
+        return TrackIndex::id_of(request);
+    }
+public:
+    void attach(const DispatchState* dispatch) override {
+        state = dispatch;
+    }
+    void add_request(RequestId request, int track) override {
+        int direction = state->requests->write(request) ? 1 : 0;
+        sorted[direction].insert(request, track);
+        fifo[direction].insert({state->requests->arrival_time(request), request});
+    }
+    bool remove_request(RequestId request, int track) override {
+        int direction = state->requests->write(request) ? 1 : 0;
+        fifo[direction].erase({state->requests->arrival_time(request), request});
+        return sorted[direction].erase(TrackIndex::key(track, request));
+    }
+    //a batch that has served FIFO_BATCH requests is over however many more it did 
+    void save_idle(std::vector<long long>& state) const override {
+        state.insert(state.end(), {batch_direction, std::min(batching, FIFO_BATCH), starved});
+    }
+    void load_idle(const std::vector<long long>& state) override {
+        batch_direction = static_cast<int>(state[0]);
+        batching = static_cast<int>(state[1]);
+        starved = static_cast<int>(state[2]);
+    }
+    void save_state(CheckpointWriter& out) const override {
+        for (int direction = 0; direction < 2; direction++) {
+            sorted[direction].save(out);
+            out.put(static_cast<long long>(fifo[direction].size()));
+            for (const auto& entry : fifo[direction]) {
+                out.put(entry.first);
+                out.put(entry.second);
+            }
         }
-        //if currently now active requests processed 
-        if (!active_request) {
-            //get the next one from the scheduler 
-            active_request = scheduler.get_next_request(current_track);
-            if (active_request) 
-            {
-                //if scheduler returned active request 
-                //intialize its start and end time according to our current track and track the requests 
-                //wants to get to 
-                active_request->start_time = current_time;
-                active_request->end_time = current_time + std::abs(active_request->track - current_track);
-             
-            }
-        }
-        //this was the only thing that differed from the pseudocode since i was 
-        //running into an issue where when we got a request from the scheduler
-        //from the previous if statement if it is already at the correct track 
-        //then we don't need to do anything 
-        if (active_request && active_request->end_time == current_time) 
-        {
-            //specifically we add it to our list of compelted requests 
-            completed_requests.push_back(*active_request);
-            //set it to null since now no active request
-            active_request = nullptr;
-            //then we must continue to next iteration since no need to increment time
-            //since nothing was done 
-            continue; 
-
+        out.put(batch_direction);
+        out.put(batching);
+        out.put(starved);
+    }
+    void load_state(CheckpointReader& in) override {
+        for (int direction = 0; direction < 2; direction++) {
+            sorted[direction].load(in);
+            fifo[direction].clear();
+            std::size_t count = in.get_count();
+            for (std::size_t i = 0; i < count; i++) {
+                long long arrival_time = in.get();
+                fifo[direction].insert(fifo[direction].end(), {arrival_time, static_cast<RequestId>(in.get())});
+            }
+        }
+        batch_direction = static_cast<int>(in.get());
+        batching = static_cast<int>(in.get());
+        starved = static_cast<int>(in.get());
+    }
+    void renumber(RequestId offset) override {
+        for (int direction = 0; direction < 2; direction++) {
+            sorted[direction].renumber(offset);
+            renumber_set(fifo[direction], offset);
         }
-        //if we have an active request 
-        if (active_request) {
-            //se which direction to move the track accoding to current traack
-            //and thhe destination track for the request 
-            if (current_track < active_request->track) {
-                current_track++;
-            } else if (current_track > active_request->track) {
-                current_track--;
+    }
+    RequestId get_next_request(int current_track) override {
+        //the batch goes on while it has requests above the head 
+        if (batching < FIFO_BATCH) {
+            std::uint64_t next_request = sorted[batch_direction].at_or_above(current_track);
+            if (next_request != TrackIndex::NONE) 
+            {
+                return take(batch_direction, next_request);
             }
-            //increment our total movement variable 
-            total_movement++;
         }
-        //if we don't have any active requests and we have reached the end of our
-        //request list this implies we have processed all of them so break 
-        if (!active_request && request_index == requests.size()) {
-            break;
+        bool reads = !sorted[0].empty(), writes = !sorted[1].empty();
+        if (!reads && !writes) 
+        {
+            return NO_REQUEST;
+        }
+        int direction = 0;
+        if (reads && !(writes && starved >= WRITES_STARVED)) {
+            if (writes) starved++;
+        } else {
+            starved = 0;
+            direction = 1;
         }
-        //increment our current time variable for next iteration 
-        current_time++;
+        //like linux only a batch of the same direction can go on from where the head is 
+        std::uint64_t next_request = direction == batch_direction ? sorted[direction].at_or_above(current_track) : TrackIndex::NONE;
+        if (expired(direction) || next_request == TrackIndex::NONE) {
+            RequestId oldest = fifo[direction].begin()->second;
+            next_request = TrackIndex::key(state->requests->track(oldest), oldest);
+        }
+        batch_direction = direction;
+        batching = 0;
+        return take(direction, next_request);
     }
-    //set the total time once we break the loop since now we have finishde with scheduling 
-    int total_time = current_time;
-    //declare our helper variables for our ouput 
-    double io_utilization = 0;
-    double avg_turnaround = 0;
-    double avg_wait_time = 0;
-    int max_wait_time = 0;
-    //go through each request and do appropriate calculations
-    //as will be used in sum line for the output 
-    for (const auto& req : completed_requests) {
-        //relatively trivial computed as given in the instructions 
-        io_utilization += (req.end_time - req.start_time);
-        avg_turnaround += (req.end_time - req.arrival_time);
-        avg_wait_time += (req.start_time - req.arrival_time);
-        max_wait_time = std::max(max_wait_time, req.start_time - req.arrival_time);
-    }
-    //for average must divide by total time or total requests 
-    io_utilization /= total_time;
-    avg_turnaround /= completed_requests.size();
-    avg_wait_time /= completed_requests.size();
-    //i had to sort the requests since i maintained a separate list for 
-    //requests that finished and since they don't necessarily finish in order
-    //i just sorted it by id 
-    std::sort(completed_requests.begin(), completed_requests.end(),
-          [](const IORequest& a, const IORequest& b) {
-              return a.id < b.id;
-          });
-    //go through each request and print its necessary information as given in
-    //the instructions, do spacing requirements as given in directions 
-    for (const auto& req : completed_requests) {
-        std::cout << std::setw(5) << req.id << ": "
-                  << std::setw(5) << req.arrival_time << " "
-                  << std::setw(5) << req.start_time << " "
-                  << std::setw(5) << req.end_time << std::endl;
-    }
-    //print out our final sum line for the ouput and apply spacing as given
-    //in the requirements 
-    std::cout << "SUM: " << total_time << " " << total_movement << " "
-              << std::fixed << std::setprecision(4) << io_utilization << " "
-              << std::fixed << std::setprecision(2) << avg_turnaround << " "
-              << std::fixed << std::setprecision(2) << avg_wait_time << " "
-              << max_wait_time<<std::endl;
-}
-//the main function that will parse input arguments, read the input file, 
-//and set up our simulation for the scheduler 
-int main(int argc, char* argv[]) {
-    //first check if all the necessary arguments are there
-    //i am only checking for the necessary ones since I did not implement the 
-    //optional arguments 
-    if (argc < 3) {
-        std::cerr << "Usage: ./iosched -s<scheduler> <inputfile>";
-        return 1;
+};
+//subclass with a simplified take on the linux BFQ scheduler. requests are queued per
+//stream and one stream at a time owns the disk until it used up its budget of
+//sectors or ran out of requests, serving its own queue in CLOOK order. the next owner
+//is the waiting stream with the earliest virtual finish time, a stream's virtual
+//time only advances by the sectors it was served so every stream gets the same share
+//of the disk however many requests it sends. every step is O(log n) 
+class BFQScheduler final : public IOScheduler {
+public:
+    static constexpr char letter = 'B';
+    //sectors a stream may be served in one turn 
+    static constexpr long long MAX_BUDGET = 64;
+private:
+    struct StreamQueue {
+        TrackIndex requests;
+        //virtual start and finish of its current or next turn 
+        long long start = 0;
+        long long finish = 0;
+    };
+    const DispatchState* state = nullptr;
+    std::unordered_map<int, StreamQueue> streams;
+    //streams with requests that wait for a turn, by (virtual finish, stream) 
+    PooledSet<std::pair<long long, int>> waiting;
+    //the stream that owns the disk and the sectors it was served this turn 
+    StreamQueue* active = nullptr;
+    int active_stream = 0;
+    long long used = 0;
+    long long virtual_time = 0;
+    void enqueue(int stream, StreamQueue& queue) {
+        queue.start = std::max(virtual_time, queue.finish);
+        queue.finish = queue.start + MAX_BUDGET;
+        waiting.insert({queue.finish, stream});
     }
-    //create a temp storage variable for out scheculer to be created 
-    //and our input file to be read 
-    std::string scheduler_arg = argv[1];
-    char scheduler_type = scheduler_arg.back(); // Extracts the last character
-    std::string input_file = argv[2];
-    //essentially read the input file pretty trivial with necessary
-    //input parsing 
-    std::ifstream infile(input_file);
-    //checking if we can open file 
-    if (!infile.is_open()) {
-        std::cerr << "Error opening file: " << input_file << "";
-        return 1;
+    //the turn is over, the stream is charged what it actually used 
+    void expire() {
+        active->finish = active->start + used;
+        if (!active->requests.empty()) enqueue(active_stream, *active);
+        active = nullptr;
     }
-    //create our list of requests that will be intiailized from reading the
-    //inpuut file 
-    std::vector<IORequest> requests;
-    std::string line;
-    //intialize our id variable for our requests objects 
-    int id = 0;
-    //read through each line 
-    while (std::getline(infile, line)) {
-        //as said in directions we ignore lines that start with # 
-        //or empty lines 
-        if (line.empty() || line[0] == '#') continue;
-        //read in the lines 
-        std::istringstream iss(line);
-        //get the 2 parameterts each line for a request object must have 
-        int arrival_time, track;
-        //if not 2 parameters there is an error 
-        if (!(iss >> arrival_time >> track)) {
-            std::cerr << "Malformed input line: " << line << "";
-            return 1;
+public:
+    void attach(const DispatchState* dispatch) override {
+        state = dispatch;
+    }
+    void add_request(RequestId request, int track) override {
+        int stream = state->requests->stream(request);
+        StreamQueue& queue = streams[stream];
+        bool idle = queue.requests.empty() && &queue != active;
+        queue.requests.insert(request, track);
+        if (idle) enqueue(stream, queue);
+    }
+    //a waiting stream that has nothing left gives up its turn 
+    bool remove_request(RequestId request, int track) override {
+        int stream = state->requests->stream(request);
+        StreamQueue& queue = streams[stream];
+        if (!queue.requests.erase(TrackIndex::key(track, request))) 
+        {
+            return false;
         }
-        //initialize reequests and add it to the list of our requests
-        requests.emplace_back(id++, arrival_time, track);
+        if (queue.requests.empty() && &queue != active) waiting.erase({queue.finish, stream});
+        return true;
     }
-    //close the file 
-    infile.close();
-    //declare our scheduler object and intitialize to our argument
-    //that we read in before hand
-    IOScheduler* scheduler = nullptr;
-    //using switch case again as we have learned much more optimal than if-else
-    switch(scheduler_type)
-    {
-        //N is for FIFO
-        case 'N':
-            scheduler= new FIFOScheduler();
-            break;
-        //S is for SSTF
-        case 'S':
-            scheduler= new SSTFScheduler();
-            break;
-        //L is for LOOK     
-        case 'L':
-            scheduler= new LOOKScheduler();
-            break;
-        //C is for CLOOK
-        case 'C':
-            scheduler= new CLOOKScheduler();
-            break;
-        //F is for FLOOK
-        case 'F':
-            scheduler= new FLOOKScheduler();
-            break;
-        //if none of the cases reached than error since these are the only
-        //schedulers we are considering 
-        default:
-            std::cerr << "Invalid scheduler type: " << scheduler_type << std::endl;
-            return 1;
+    //only how far a stream's finish is ahead of the virtual time matters, one that is
+    //behind starts its next turn at the virtual time anyway. so the state is the
+    //streams that are ahead and by how much, in stream order 
+    void save_idle(std::vector<long long>& state) const override {
+        std::vector<std::pair<int, long long>> ahead;
+        for (const auto& entry : streams) {
+            if (entry.second.finish > virtual_time) ahead.push_back({entry.first, entry.second.finish - virtual_time});
+        }
+        std::sort(ahead.begin(), ahead.end());
+        for (const auto& entry : ahead) state.insert(state.end(), {entry.first, entry.second});
     }
-    //start our simulation
-    simulate_io_scheduler(*scheduler, requests);
-    //delete the scheduler 
-    delete scheduler;
-    //trivial return statement 
+    void load_idle(const std::vector<long long>& state) override {
+        streams.clear();
+        active = nullptr;
+        virtual_time = 0;
+        for (std::size_t i = 0; i + 1 < state.size(); i += 2) streams[static_cast<int>(state[i])].finish = state[i + 1];
+    }
+    //streams are saved in stream order, the waiting set and the owner of the disk refer to them by stream 
+    void save_state(CheckpointWriter& out) const override {
+        std::vector<int> ids;
+        for (const auto& entry : streams) ids.push_back(entry.first);
+        std::sort(ids.begin(), ids.end());
+        out.put(static_cast<long long>(ids.size()));
+        for (int stream : ids) {
+            const StreamQueue& queue = streams.at(stream);
+            out.put(stream);
+            out.put(queue.start);
+            out.put(queue.finish);
+            queue.requests.save(out);
+        }
+        out.put(static_cast<long long>(waiting.size()));
+        for (const auto& entry : waiting) {
+            out.put(entry.first);
+            out.put(entry.second);
+        }
+        out.put(active != nullptr);
+        out.put(active_stream);
+        out.put(used);
+        out.put(virtual_time);
+    }
+    void load_state(CheckpointReader& in) override {
+        std::size_t count = in.get_count();
+        for (std::size_t i = 0; i < count; i++) {
+            StreamQueue& queue = streams[static_cast<int>(in.get())];
+            queue.start = in.get();
+            queue.finish = in.get();
+            queue.requests.load(in);
+        }
+        count = in.get_count();
+        for (std::size_t i = 0; i < count; i++) {
+            long long finish = in.get();
+            waiting.insert({finish, static_cast<int>(in.get())});
+        }
+        bool owned = in.get() != 0;
+        active_stream = static_cast<int>(in.get());
+        active = owned ? &streams[active_stream] : nullptr;
+        used = in.get();
+        virtual_time = in.get();
+    }
+    void renumber(RequestId offset) override {
+        for (auto& entry : streams) entry.second.requests.renumber(offset);
+    }
+    RequestId get_next_request(int current_track) override {
+        if (active != nullptr && (used >= MAX_BUDGET || active->requests.empty())) expire();
+        if (active == nullptr) {
+            if (waiting.empty()) 
+            {
+                return NO_REQUEST;
+            }
+            active_stream = waiting.begin()->second;
+            waiting.erase(waiting.begin());
+            active = &streams[active_stream];
+            virtual_time = std::max(virtual_time, active->start);
+            used = 0;
+        }
+        std::uint64_t next_request = active->requests.at_or_above(current_track);
+        if (next_request == TrackIndex::NONE) next_request = active->requests.lowest();
+        active->requests.erase(next_request);
+        RequestId id = TrackIndex::id_of(next_request);
+        used += std::max(1, state->requests->size(id));
+        return id;
+    }
+};
+
+//arrival time and destination track of one request line in the input file. times
+//are 64 bit so a live run can go on past 2^31 time units 
+struct TraceEntry {
+    long long arrival_time;
+    int track;
+    //optional columns after the track in this order: the device of the request in
+    //tagged multi disk mode, the sector on the track and the size in sectors for the
+    //service model, 1 for a write and the stream id for the deadline and BFQ schedulers 
+    int device = 0;
+    int sector = 0;
+    int size = 1;
+    int write = 0;
+    int stream = 0;
+};
+//parses the two integers of a request line the same way reading them with
+//`iss >> arrival_time >> track` did: leading whitespace is skipped, an optional sign,
+//at least one digit and anything after the second number is ignored. its hand rolled
+//since building an istringstream for every line was most of the cost of reading a trace.
+//the arrival time is read as a long long and every other column as an int 
+template <typename T>
+static bool scan_int(const char*& pos, const char* end, T& value) {
+    while (pos < end && (*pos == ' ' || (*pos >= '\t' && *pos <= '\r'))) pos++;
+    bool negative = false;
+    if (pos < end && (*pos == '-' || *pos == '+')) 
+    {
+        negative = *pos == '-';
+        pos++;
+    }
+    if (pos == end || *pos < '0' || *pos > '9') 
+    {
+        return false;
+    }
+    const std::uint64_t limit = static_cast<std::uint64_t>(std::numeric_limits<T>::max()) + negative;
+    std::uint64_t result = 0;
+    while (pos < end && *pos >= '0' && *pos <= '9') {
+        unsigned digit = static_cast<unsigned>(*pos - '0');
+        //out of range numbers made the stream fail too 
+        if (result > (limit - digit) / 10) 
+        {
+            return false;
+        }
+        result = result * 10 + digit;
+        pos++;
+    }
+    value = static_cast<T>(negative ? 0 - result : result);
+    return true;
+}
+static bool parse_request_line(const char* begin, const char* end, TraceEntry& entry) {
+    if (!scan_int(begin, end, entry.arrival_time) || !scan_int(begin, end, entry.track)) 
+    {
+        return false;
+    }
+    //the optional columns are only used when they are numbers, anything else after
+    //the track is still ignored like it always was 
+    //every column that is there has to be a number for the ones after it to count 
+    TraceEntry defaults;
+    int* columns[] = {&entry.device, &entry.sector, &entry.size, &entry.write, &entry.stream};
+    const int* fallback[] = {&defaults.device, &defaults.sector, &defaults.size, &defaults.write, &defaults.stream};
+    bool present = true;
+    for (int i = 0; i < 5; i++) {
+        present = present && scan_int(begin, end, *columns[i]);
+        if (!present) *columns[i] = *fallback[i];
+    }
+    return true;
+}
+//reads the input file one request at a time from a stream, skipping comments and
+//empty lines. used for inputs that can't be memory mapped like pipes 
+class TraceReader {
+private:
+    std::istream& in;
+    //last line read, kept around so a malformed line can be reported 
+    std::string line;
+    std::size_t line_number = 0;
+    bool malformed = false;
+public:
+    explicit TraceReader(std::istream& in) : in(in) {}
+    //reads the next request, returns false at the end of the file or on a malformed line 
+    bool next(TraceEntry& entry) {
+        while (!malformed && std::getline(in, line)) {
+            line_number++;
+            //as said in directions we ignore lines that start with # 
+            //or empty lines 
+            if (line.empty() || line[0] == '#') continue;
+            //if not 2 parameters there is an error 
+            if (!parse_request_line(line.data(), line.data() + line.size(), entry)) {
+                malformed = true;
+                return false;
+            }
+            return true;
+        }
+        return false;
+    }
+    bool failed() const { return malformed; }
+    std::string error() const {
+        return problem("Malformed input line ");
+    }
+    //what is wrong with the last line read, followed by its number and the line 
+    std::string problem(const std::string& what) const {
+        return what + std::to_string(line_number) + ": " + line;
+    }
+    //the number of requests isn't known up front for text 
+    std::size_t size_hint() const { return 0; }
+};
+//read only memory mapping of a whole input file. the readers scan it in place so
+//there is no copy and no allocation per request, and when we stream a huge trace
+//the pages we are done with are handed back every so often so they don't pile up
+class MappedFile {
+private:
+    const char* data = nullptr;
+    std::size_t length = 0;
+    //start of the pages that have not been released yet 
+    std::size_t released = 0;
+    //how many bytes we read past before handing the pages back to the kernel 
+    static const std::size_t RELEASE_CHUNK = 8 << 20;
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() {
+        if (data) munmap(const_cast<char*>(data), length);
+    }
+    //maps the file, returns false if it can't be opened or isn't a regular file 
+    bool open(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) 
+        {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) 
+        {
+            close(fd);
+            return false;
+        }
+        length = static_cast<std::size_t>(st.st_size);
+        //an empty file can't be mapped but it is a valid (empty) trace 
+        if (length > 0) 
+        {
+            void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) 
+            {
+                close(fd);
+                return false;
+            }
+            madvise(mapped, length, MADV_SEQUENTIAL);
+            data = static_cast<const char*>(mapped);
+        }
+        close(fd);
+        return true;
+    }
+    const char* begin() const { return data; }
+    const char* end() const { return data + length; }
+    std::size_t size() const { return length; }
+    //called as a reader moves forward, drops the whole pages before pos from our
+    //address space once enough piled up. the file stays in the page cache so this is cheap 
+    void consumed(const char* pos) {
+        std::size_t offset = static_cast<std::size_t>(pos - data);
+        //a new reader went back to the start, like each pass of the conversion. the
+        //pages it reads again come back from the page cache 
+        if (offset < released) 
+        {
+            released = 0;
+        }
+        if (offset - released < RELEASE_CHUNK) 
+        {
+            return;
+        }
+        std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        std::size_t upto = (offset / page) * page;
+        madvise(const_cast<char*>(data + released), upto - released, MADV_DONTNEED);
+        released = upto;
+    }
+};
+//reads a text trace out of a memory mapped file 
+class MappedTraceReader {
+private:
+    MappedFile& file;
+    const char* pos;
+    //start and end of the last line read, for reporting a malformed line 
+    const char* line_begin;
+    const char* line_end;
+    std::size_t line_number = 0;
+    bool malformed = false;
+public:
+    explicit MappedTraceReader(MappedFile& file)
+            : file(file), pos(file.begin()), line_begin(file.begin()), line_end(file.begin()) {}
+    //reads the next request, returns false at the end of the file or on a malformed line 
+    bool next(TraceEntry& entry) {
+        const char* end = file.end();
+        while (!malformed && pos < end) {
+            line_begin = pos;
+            const char* newline = static_cast<const char*>(memchr(pos, '\n', end - pos));
+            line_end = newline ? newline : end;
+            pos = newline ? newline + 1 : end;
+            line_number++;
+            file.consumed(line_begin);
+            //as said in directions we ignore lines that start with # 
+            //or empty lines 
+            if (line_begin == line_end || *line_begin == '#') continue;
+            if (!parse_request_line(line_begin, line_end, entry)) {
+                malformed = true;
+                return false;
+            }
+            return true;
+        }
+        return false;
+    }
+    bool failed() const { return malformed; }
+    std::string error() const {
+        return "Malformed input line " + std::to_string(line_number) + ": " + std::string(line_begin, line_end);
+    }
+    //the number of requests isn't known up front for text 
+    std::size_t size_hint() const { return 0; }
+};
+
+//compact binary trace format, all fields little endian:
+//  header      BinaryTraceHeader, its fields in order without padding
+//  arrivals    count zigzag varints, each the difference to the previous arrival time
+//              (the first one to 0), so a sorted trace mostly takes a byte per request
+//  tracks      count fixed width unsigned values of track - min_track, track_width bytes each
+//  columns     for every optional column in the columns bit mask, in the order of
+//              BINARY_TRACE_COLUMNS, its length in bytes as a uint64 and then count
+//              zigzag varints of its values. columns that only have default values are left out
+//written by ./iosched -o <binfile> <textfile> and recognized by its magic when loading.
+//the first version (magic IOSCHED1) had no optional columns and reads as before 
+struct BinaryTraceHeader {
+    char magic[8];
+    uint64_t count;
+    int32_t min_track;
+    int32_t max_track;
+    uint32_t track_width;
+    uint32_t columns;
+    uint64_t arrival_bytes;
+};
+static const char BINARY_TRACE_MAGIC[8] = {'I', 'O', 'S', 'C', 'H', 'E', 'D', '2'};
+static const char BINARY_TRACE_MAGIC_V1[8] = {'I', 'O', 'S', 'C', 'H', 'E', 'D', '1'};
+//the optional columns of a request the binary format can hold, bit i of the columns
+//mask is the i-th one. new columns only ever go at the end 
+static int TraceEntry::* const BINARY_TRACE_COLUMNS[] = {&TraceEntry::device, &TraceEntry::sector, &TraceEntry::size, &TraceEntry::write,
+                                                         &TraceEntry::stream};
+static const int BINARY_TRACE_COLUMN_COUNT = sizeof(BINARY_TRACE_COLUMNS) / sizeof(BINARY_TRACE_COLUMNS[0]);
+static const std::size_t BINARY_TRACE_HEADER_BYTES = 40;
+//the header goes through these byte by byte instead of a memcpy of the struct, so a
+//trace reads the same on a big endian machine 
+static void store_le(unsigned char*& out, std::uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) *out++ = static_cast<unsigned char>(value >> (8 * i));
+}
+static std::uint64_t load_le(const unsigned char*& in, int bytes) {
+    std::uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) value |= static_cast<std::uint64_t>(*in++) << (8 * i);
+    return value;
+}
+static void encode_header(const BinaryTraceHeader& header, unsigned char* out) {
+    memcpy(out, header.magic, sizeof(header.magic));
+    out += sizeof(header.magic);
+    store_le(out, header.count, 8);
+    store_le(out, static_cast<std::uint32_t>(header.min_track), 4);
+    store_le(out, static_cast<std::uint32_t>(header.max_track), 4);
+    store_le(out, header.track_width, 4);
+    store_le(out, header.columns, 4);
+    store_le(out, header.arrival_bytes, 8);
+}
+static BinaryTraceHeader decode_header(const unsigned char* in) {
+    BinaryTraceHeader header;
+    memcpy(header.magic, in, sizeof(header.magic));
+    in += sizeof(header.magic);
+    header.count = load_le(in, 8);
+    header.min_track = static_cast<std::int32_t>(static_cast<std::uint32_t>(load_le(in, 4)));
+    header.max_track = static_cast<std::int32_t>(static_cast<std::uint32_t>(load_le(in, 4)));
+    header.track_width = static_cast<std::uint32_t>(load_le(in, 4));
+    header.columns = static_cast<std::uint32_t>(load_le(in, 4));
+    header.arrival_bytes = load_le(in, 8);
+    return header;
+}
+
+static bool is_binary_trace(const MappedFile& file) {
+    return file.size() >= BINARY_TRACE_HEADER_BYTES && (memcmp(file.begin(), BINARY_TRACE_MAGIC, sizeof(BINARY_TRACE_MAGIC)) == 0
+                                                        || memcmp(file.begin(), BINARY_TRACE_MAGIC_V1, sizeof(BINARY_TRACE_MAGIC_V1)) == 0);
+}
+//decodes a binary trace straight out of the mapping, one request at a time 
+class BinaryTraceReader {
+private:
+    MappedFile& file;
+    BinaryTraceHeader header;
+    const unsigned char* arrival_pos = nullptr;
+    const unsigned char* arrival_end = nullptr;
+    const unsigned char* tracks = nullptr;
+    //where the next value of each optional column in the file is 
+    struct Column {
+        int TraceEntry::* field;
+        const unsigned char* pos;
+        const unsigned char* end;
+    };
+    std::vector<Column> columns;
+    std::uint64_t index = 0;
+    long long arrival_time = 0;
+    std::string problem;
+    //zigzag varint at pos, false if the column ends in the middle of it 
+    static bool read_varint(const unsigned char*& pos, const unsigned char* end, long long& value) {
+        std::uint64_t zigzag = 0;
+        int shift = 0;
+        while (true) {
+            if (pos == end || shift > 63) 
+            {
+                return false;
+            }
+            unsigned char byte = *pos++;
+            zigzag |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            shift += 7;
+            if (!(byte & 0x80)) break;
+        }
+        value = static_cast<long long>(zigzag >> 1) ^ -static_cast<long long>(zigzag & 1);
+        return true;
+    }
+public:
+    explicit BinaryTraceReader(MappedFile& file) : file(file) {
+        header = decode_header(reinterpret_cast<const unsigned char*>(file.begin()));
+        //the first version had no optional columns, the field was reserved 
+        if (memcmp(header.magic, BINARY_TRACE_MAGIC_V1, sizeof(header.magic)) == 0) header.columns = 0;
+        arrival_pos = reinterpret_cast<const unsigned char*>(file.begin()) + BINARY_TRACE_HEADER_BYTES;
+        std::size_t available = file.size() - BINARY_TRACE_HEADER_BYTES;
+        //check up front that the columns the header promises are really there 
+        if ((header.track_width != 1 && header.track_width != 2 && header.track_width != 4) ||
+            header.arrival_bytes > available ||
+            header.count > (available - header.arrival_bytes) / header.track_width ||
+            (header.columns >> BINARY_TRACE_COLUMN_COUNT) != 0) {
+            problem = "Truncated or corrupt binary trace";
+            header.count = 0;
+            return;
+        }
+        arrival_end = arrival_pos + header.arrival_bytes;
+        tracks = arrival_end;
+        const unsigned char* pos = tracks + header.count * header.track_width;
+        const unsigned char* end = reinterpret_cast<const unsigned char*>(file.end());
+        for (int i = 0; i < BINARY_TRACE_COLUMN_COUNT; i++) {
+            if (!(header.columns & (1u << i))) continue;
+            std::uint64_t length = static_cast<std::uint64_t>(end - pos) >= 8 ? load_le(pos, 8) : std::numeric_limits<std::uint64_t>::max();
+            if (length > static_cast<std::uint64_t>(end - pos)) {
+                problem = "Truncated or corrupt binary trace";
+                header.count = 0;
+                return;
+            }
+            columns.push_back({BINARY_TRACE_COLUMNS[i], pos, pos + length});
+            pos += length;
+        }
+    }
+    bool next(TraceEntry& entry) {
+        if (index == header.count || !problem.empty()) 
+        {
+            return false;
+        }
+        //varint of the zigzag encoded difference to the previous arrival 
+        long long delta;
+        if (!read_varint(arrival_pos, arrival_end, delta)) 
+        {
+            problem = "Truncated arrival column in binary trace at request " + std::to_string(index);
+            return false;
+        }
+        arrival_time += delta;
+        const unsigned char* track = tracks + index * header.track_width;
+        std::uint32_t offset = track[0];
+        if (header.track_width >= 2) offset |= static_cast<std::uint32_t>(track[1]) << 8;
+        if (header.track_width == 4) offset |= static_cast<std::uint32_t>(track[2]) << 16 | static_cast<std::uint32_t>(track[3]) << 24;
+        //columns that aren't in the file keep their defaults 
+        entry = TraceEntry();
+        entry.arrival_time = arrival_time;
+        entry.track = static_cast<int>(static_cast<std::int64_t>(header.min_track) + offset);
+        for (Column& column : columns) {
+            long long value;
+            if (!read_varint(column.pos, column.end, value)) 
+            {
+                problem = "Truncated column in binary trace at request " + std::to_string(index);
+                return false;
+            }
+            entry.*column.field = static_cast<int>(value);
+        }
+        index++;
+        file.consumed(reinterpret_cast<const char*>(arrival_pos));
+        return true;
+    }
+    bool failed() const { return !problem.empty(); }
+    std::string error() const { return problem; }
+    //the header tells us the request count so loading can size its arrays once 
+    std::size_t size_hint() const { return static_cast<std::size_t>(header.count); }
+};
+//converts a text trace into the binary format. reads the input once to size the
+//header and columns and then once for each column, so it never holds the trace in
+//memory. returns an error message, empty on success 
+static std::string convert_trace(MappedFile& input, const std::string& output_file) {
+    BinaryTraceHeader header;
+    memcpy(header.magic, BINARY_TRACE_MAGIC, sizeof(header.magic));
+    header.count = 0;
+    header.min_track = std::numeric_limits<int>::max();
+    header.max_track = std::numeric_limits<int>::min();
+    header.columns = 0;
+    header.arrival_bytes = 0;
+    //zigzag varint of the difference between two arrival times, or of a column value to 0 
+    auto encode_arrival = [](long long previous, long long current, unsigned char* out) {
+        long long delta = current - previous;
+        std::uint64_t zigzag = (static_cast<std::uint64_t>(delta) << 1) ^ static_cast<std::uint64_t>(delta >> 63);
+        int bytes = 0;
+        do {
+            unsigned char byte = zigzag & 0x7f;
+            zigzag >>= 7;
+            out[bytes++] = byte | (zigzag ? 0x80 : 0);
+        } while (zigzag);
+        return bytes;
+    };
+    unsigned char buffer[10];
+    TraceEntry entry;
+    const TraceEntry defaults{0, 0};
+    long long previous = 0;
+    std::uint64_t column_bytes[BINARY_TRACE_COLUMN_COUNT] = {};
+    {
+        MappedTraceReader reader(input);
+        while (reader.next(entry)) {
+            header.count++;
+            header.min_track = std::min(header.min_track, entry.track);
+            header.max_track = std::max(header.max_track, entry.track);
+            header.arrival_bytes += encode_arrival(previous, entry.arrival_time, buffer);
+            previous = entry.arrival_time;
+            //an optional column is only written if some request doesn't have the default 
+            for (int i = 0; i < BINARY_TRACE_COLUMN_COUNT; i++) {
+                int value = entry.*BINARY_TRACE_COLUMNS[i];
+                column_bytes[i] += encode_arrival(0, value, buffer);
+                if (value != defaults.*BINARY_TRACE_COLUMNS[i]) header.columns |= 1u << i;
+            }
+        }
+        if (reader.failed()) 
+        {
+            return reader.error();
+        }
+    }
+    if (header.count == 0) 
+    {
+        header.min_track = header.max_track = 0;
+    }
+    std::uint64_t range = static_cast<std::uint64_t>(static_cast<std::int64_t>(header.max_track) - header.min_track);
+    header.track_width = range <= 0xff ? 1 : range <= 0xffff ? 2 : 4;
+    std::ofstream out(output_file, std::ios::binary);
+    if (!out.is_open()) 
+    {
+        return "Error opening file: " + output_file;
+    }
+    unsigned char encoded[BINARY_TRACE_HEADER_BYTES];
+    encode_header(header, encoded);
+    out.write(reinterpret_cast<const char*>(encoded), sizeof(encoded));
+    previous = 0;
+    {
+        MappedTraceReader reader(input);
+        while (reader.next(entry)) {
+            out.write(reinterpret_cast<const char*>(buffer), encode_arrival(previous, entry.arrival_time, buffer));
+            previous = entry.arrival_time;
+        }
+    }
+    {
+        MappedTraceReader reader(input);
+        while (reader.next(entry)) {
+            std::uint32_t offset = static_cast<std::uint32_t>(static_cast<std::int64_t>(entry.track) - header.min_track);
+            for (std::uint32_t i = 0; i < header.track_width; i++) {
+                buffer[i] = static_cast<unsigned char>(offset >> (8 * i));
+            }
+            out.write(reinterpret_cast<const char*>(buffer), header.track_width);
+        }
+    }
+    for (int i = 0; i < BINARY_TRACE_COLUMN_COUNT; i++) {
+        if (!(header.columns & (1u << i))) continue;
+        unsigned char* length = buffer;
+        store_le(length, column_bytes[i], 8);
+        out.write(reinterpret_cast<const char*>(buffer), 8);
+        MappedTraceReader reader(input);
+        while (reader.next(entry)) {
+            out.write(reinterpret_cast<const char*>(buffer), encode_arrival(0, entry.*BINARY_TRACE_COLUMNS[i], buffer));
+        }
+    }
+    if (!out) 
+    {
+        return "Error writing file: " + output_file;
+    }
+    return "";
+}
+//replays a trace that has already been loaded into memory, or the requests from begin
+//up to end of it 
+class TraceArraySource {
+private:
+    const std::vector<TraceEntry>& trace;
+    std::size_t index;
+    std::size_t end;
+public:
+    explicit TraceArraySource(const std::vector<TraceEntry>& trace) : trace(trace), index(0), end(trace.size()) {}
+    TraceArraySource(const std::vector<TraceEntry>& trace, std::size_t begin, std::size_t end) : trace(trace), index(begin), end(end) {}
+    bool next(TraceEntry& entry) {
+        if (index == end) 
+        {
+            return false;
+        }
+        entry = trace[index++];
+        return true;
+    }
+    bool failed() const { return false; }
+};
+
+//settings for one simulation run that come from the command line 
+//how requests are spread over the disks of an array in multi disk mode. striping
+//puts every stripe of `width` tracks on the next disk, hashing scatters single tracks
+//and tagging takes the disk from the third column of the input 
+struct DeviceRouting {
+    enum Rule { STRIPE, HASH, TAG };
+    //one device is the plain single disk simulation 
+    int devices = 1;
+    Rule rule = STRIPE;
+    int width = 64;
+    //parses the argument of -D, `<devices>[,stripe<width>|,hash|,tag]` 
+    bool parse(const std::string& arg) {
+        std::size_t comma = arg.find(',');
+        devices = atoi(arg.substr(0, comma).c_str());
+        if (devices < 1) return false;
+        if (comma == std::string::npos) return true;
+        std::string name = arg.substr(comma + 1);
+        if (name == "hash") {
+            rule = HASH;
+        } else if (name == "tag") {
+            rule = TAG;
+        } else if (name.compare(0, 6, "stripe") == 0) {
+            rule = STRIPE;
+            if (name.size() > 6) width = atoi(name.c_str() + 6);
+            if (width < 1) return false;
+        } else {
+            return false;
+        }
+        return true;
+    }
+    //picks the device of the request and rewrites its track to the track on that
+    //device, returns false for a tag outside of the array 
+    bool route(TraceEntry& entry) const {
+        if (rule == TAG) {
+            return entry.device >= 0 && entry.device < devices;
+        }
+        long long track = entry.track;
+        if (rule == HASH) {
+            //the track stays, the disks just see a scattered subset of them 
+            std::uint64_t mixed = static_cast<std::uint64_t>(track) * 0x9E3779B97F4A7C15ull;
+            entry.device = static_cast<int>((mixed >> 32) % static_cast<std::uint64_t>(devices));
+            return true;
+        }
+        //floored division so negative tracks stripe the same way as positive ones 
+        long long stripe = floor_div(track, width);
+        entry.device = static_cast<int>(stripe - floor_div(stripe, devices) * devices);
+        entry.track = static_cast<int>(floor_div(stripe, devices) * width + (track - stripe * width));
+        return true;
+    }
+private:
+    static long long floor_div(long long a, long long b) {
+        return a >= 0 ? a / b : -((-a + b - 1) / b);
+    }
+};
+struct SimulationOptions {
+    //-q only prints the sum line and skips the line for every request 
+    bool quiet = false;
+    //-P adds wait and turnaround percentiles after the sum line, as text or json 
+    enum Percentiles { PERCENTILES_OFF, PERCENTILES_TEXT, PERCENTILES_JSON };
+    Percentiles percentiles = PERCENTILES_OFF;
+    //-D spreads the requests over several disks, each with its own scheduler 
+    DeviceRouting routing;
+    //-p loads a device profile for the service time 
+    ServiceModel model;
+    //-M<limit> merges waiting requests on the same and the following tracks into the
+    //request being dispatched, up to limit requests in one operation. off below 2 
+    int merge_limit = 0;
+    //-T<interval>,<file> samples the simulation every interval time units into file,
+    //csv unless the file name ends in .bin. off while the interval is 0 
+    long long telemetry_interval = 0;
+    std::string telemetry_path;
+    //-Q<depth>[,sstf|,rpo] puts a command queue like NCQ in the disk. the scheduler
+    //hands requests to the disk as long as it has room for them and the disk picks what
+    //to serve itself, the closest track or with rpo the shortest modeled positioning
+    //time. off while the depth is 0 
+    int queue_depth = 0;
+    bool queue_rotational = false;
+    //-L<interval>[,<window>] runs live on a stream that is still being written, every
+    //finished request is printed before we wait for more input, a sum line for the
+    //last interval is printed every interval time units (never while it is 0) and
+    //arrivals may come up to window time units out of order. an arrival further back
+    //than that fails the run like a malformed line 
+    long long live_interval = 0;
+    long long reorder_window = 0;
+    bool live = false;
+    //-I<pieces> cuts a loaded trace at idle periods into about that many pieces that
+    //are simulated in parallel, 1 is the plain run over the whole trace 
+    int pieces = 1;
+    //-C<seconds>,<file> saves the whole simulation to file every that many seconds of
+    //wall time, off while the file is empty. -R<file> resumes from such a checkpoint,
+    //resume_state is what it saved after the scheduler and options 
+    double checkpoint_seconds = 0;
+    std::string checkpoint_path;
+    std::string resume_state;
+};
+//fixed size histogram of non negative times with log sized buckets like HdrHistogram.
+//values below 256 have a bucket each, above that every power of two range is split
+//into 128 buckets so a bucket is never wider than 1/128 of its values. that is 3328
+//counters whatever the trace length, so percentiles work when streaming too 
+class LatencyHistogram {
+private:
+    static const int EXACT = 256;
+    static const int SUB_BUCKETS = 128;
+    static const int BUCKETS = EXACT + 24 * SUB_BUCKETS;
+    std::uint64_t counts[BUCKETS] = {};
+    std::uint64_t total = 0;
+    std::uint32_t max_value = 0;
+    static int index_of(std::uint32_t value) {
+        if (value < EXACT) 
+        {
+            return static_cast<int>(value);
+        }
+        //shift that brings the value into [128, 256) 
+        int shift = 31 - __builtin_clz(value) - 7;
+        return EXACT + (shift - 1) * SUB_BUCKETS + static_cast<int>((value >> shift) - SUB_BUCKETS);
+    }
+    //the highest value that lands in the bucket 
+    static std::uint32_t highest_of(int index) {
+        if (index < EXACT) 
+        {
+            return static_cast<std::uint32_t>(index);
+        }
+        int shift = (index - EXACT) / SUB_BUCKETS + 1;
+        std::uint64_t low = static_cast<std::uint64_t>((index - EXACT) % SUB_BUCKETS + SUB_BUCKETS) << shift;
+        return static_cast<std::uint32_t>(low + (1ull << shift) - 1);
+    }
+public:
+    //a time past 2^32 goes into the last bucket as 2^32 - 1 
+    void record(long long value) {
+        std::uint32_t v = static_cast<std::uint32_t>(std::min<long long>(std::max(value, 0ll), std::numeric_limits<std::uint32_t>::max()));
+        counts[index_of(v)]++;
+        total++;
+        max_value = std::max(max_value, v);
+    }
+    void add(const LatencyHistogram& other) {
+        for (int i = 0; i < BUCKETS; i++) counts[i] += other.counts[i];
+        total += other.total;
+        max_value = std::max(max_value, other.max_value);
+    }
+    std::uint64_t count() const { return total; }
+    std::uint32_t max() const { return max_value; }
+    //the value below which the given percent of the recorded values are, reported as
+    //the top of its bucket but never above the largest recorded value 
+    std::uint32_t percentile(double percent) const {
+        std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(percent / 100 * total));
+        rank = std::max<std::uint64_t>(rank, 1);
+        std::uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            seen += counts[i];
+            if (seen >= rank) return std::min(highest_of(i), max_value);
+        }
+        return max_value;
+    }
+    //only the buckets that were hit, as the gap to the previous one and the count 
+    void save(CheckpointWriter& out) const {
+        int used = 0;
+        for (int i = 0; i < BUCKETS; i++) used += counts[i] != 0;
+        out.put(used);
+        int previous = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            if (counts[i] == 0) continue;
+            out.put(i - previous);
+            out.put(static_cast<long long>(counts[i]));
+            previous = i;
+        }
+        out.put(static_cast<long long>(total));
+        out.put(max_value);
+    }
+    void load(CheckpointReader& in) {
+        std::fill(counts, counts + BUCKETS, 0);
+        std::size_t used = in.get_count();
+        long long index = 0;
+        for (std::size_t i = 0; i < used; i++) {
+            index += in.get();
+            std::uint64_t count = static_cast<std::uint64_t>(in.get());
+            if (index >= 0 && index < BUCKETS) counts[index] = count;
+        }
+        total = static_cast<std::uint64_t>(in.get());
+        max_value = static_cast<std::uint32_t>(in.get());
+    }
+};
+//wait and turnaround distributions of the completed requests 
+struct LatencyStats {
+    LatencyHistogram wait;
+    LatencyHistogram turnaround;
+    void add(const LatencyStats& other) {
+        wait.add(other.wait);
+        turnaround.add(other.turnaround);
+    }
+};
+//totals of a run that make up its sum line. kept as integers so the averages come
+//out exactly as when we summed up the whole list of completed requests at the end,
+//and so the totals of several devices can be added up 
+struct SimulationSummary {
+    long long total_time = 0;
+    long long total_movement = 0;
+    long long busy_time = 0;
+    long long total_turnaround = 0;
+    long long total_wait_time = 0;
+    long long max_wait_time = 0;
+    std::size_t completed = 0;
+    //how many devices were busy during total_time, utilization is per device 
+    int devices = 1;
+    //requests that were served as part of another ones operation 
+    long long merged = 0;
+    //only there when percentiles were asked for 
+    std::unique_ptr<LatencyStats> latency;
+    //where the head stopped, the track the run after this one would start from 
+    int final_track = 0;
+    void add(const SimulationSummary& other) {
+        if (other.latency) {
+            if (!latency) latency.reset(new LatencyStats());
+            latency->add(*other.latency);
+        }
+        total_time = std::max(total_time, other.total_time);
+        total_movement += other.total_movement;
+        busy_time += other.busy_time;
+        total_turnaround += other.total_turnaround;
+        total_wait_time += other.total_wait_time;
+        max_wait_time = std::max(max_wait_time, other.max_wait_time);
+        completed += other.completed;
+        merged += other.merged;
+    }
+    //the running totals of a checkpoint, the histograms are only loaded when this run
+    //keeps them too 
+    void save(CheckpointWriter& out) const {
+        for (long long value : {total_time, total_movement, busy_time, total_turnaround, total_wait_time, max_wait_time,
+                                static_cast<long long>(completed), merged}) {
+            out.put(value);
+        }
+        out.put(latency != nullptr);
+        if (latency) {
+            latency->wait.save(out);
+            latency->turnaround.save(out);
+        }
+    }
+    void load(CheckpointReader& in) {
+        total_time = in.get();
+        total_movement = in.get();
+        busy_time = in.get();
+        total_turnaround = in.get();
+        total_wait_time = in.get();
+        max_wait_time = in.get();
+        completed = static_cast<std::size_t>(in.get());
+        merged = in.get();
+        if (in.get() != 0 && latency) {
+            latency->wait.load(in);
+            latency->turnaround.load(in);
+        }
+    }
+};
+//where a run starts. a whole trace starts at time 0 with the head on track 0, a piece
+//of it in the parallel mode starts at its first arrival where the piece before it left the head 
+struct SimulationStart {
+    long long time = 0;
+    int track = 0;
+};
+//output stage of the simulator. lines are formatted by hand into one big buffer
+//that is reused for the whole run and handed to the stream in a single write
+//whenever it fills up, instead of going through setw for every field and flushing
+//with endl on every request. the bytes are exactly what the old printing produced 
+class OutputWriter {
+private:
+    std::ostream& out;
+    bool quiet;
+    std::unique_ptr<char[]> buffer;
+    std::size_t used = 0;
+    //bytes handed to the stream so far, where the output of a checkpoint ends 
+    long long written = 0;
+    //room for a whole buffer of request lines before we have to write 
+    static const std::size_t CAPACITY = 1 << 20;
+    //longest line we ever format, the sum line with huge numbers 
+    static const std::size_t MAX_LINE = 256;
+public:
+    OutputWriter(std::ostream& out, bool quiet)
+            : out(out), quiet(quiet), buffer(new char[CAPACITY]) {}
+    OutputWriter(const OutputWriter&) = delete;
+    OutputWriter& operator=(const OutputWriter&) = delete;
+    ~OutputWriter() { flush(); }
+    //"%5d: %5d %5d %5d" line for a finished request, 64 bit so a live run never wraps 
+    void request(long long id, long long arrival_time, long long start_time, long long end_time) {
+        if (quiet) 
+        {
+            return;
+        }
+        reserve();
+        char* pos = buffer.get() + used;
+        pos = write_int(pos, id);
+        *pos++ = ':';
+        *pos++ = ' ';
+        pos = write_int(pos, arrival_time);
+        *pos++ = ' ';
+        pos = write_int(pos, start_time);
+        *pos++ = ' ';
+        pos = write_int(pos, end_time);
+        *pos++ = '\n';
+        used = pos - buffer.get();
+    }
+    //the sum line, the doubles go through snprintf which is what the stream
+    //used underneath for std::fixed so the rounding is identical. the label lets
+    //multi disk mode print a sum line per device 
+    void sum(const SimulationSummary& summary, const std::string& label = "SUM") {
+        //for average must divide by total time or total requests. a disk of an array
+        //that got no requests (or an empty trace) has neither and prints zeros 
+        double io_utilization = summary.total_time == 0 ? 0 : static_cast<double>(summary.busy_time) / (static_cast<double>(summary.total_time) * summary.devices);
+        double avg_turnaround = summary.completed == 0 ? 0 : static_cast<double>(summary.total_turnaround) / summary.completed;
+        double avg_wait_time = summary.completed == 0 ? 0 : static_cast<double>(summary.total_wait_time) / summary.completed;
+        reserve();
+        used += snprintf(buffer.get() + used, MAX_LINE, "%s: %lld %lld %.4f %.2f %.2f %lld\n", label.c_str(), summary.total_time,
+                         summary.total_movement, io_utilization, avg_turnaround, avg_wait_time, summary.max_wait_time);
+        flush();
+    }
+    //how many requests were merged into others and into how many operations, after the sum line 
+    void merges(const SimulationSummary& summary, const std::string& label = "") {
+        reserve();
+        used += snprintf(buffer.get() + used, MAX_LINE, "%sMERGED: %lld %lld\n", label.c_str(), summary.merged,
+                         static_cast<long long>(summary.completed) - summary.merged);
+        flush();
+    }
+    //percentile lines that go after a sum line, the label prefixes them for a device
+    //in multi disk mode (device is -1 for the whole run) 
+    void percentiles(const LatencyStats& latency, SimulationOptions::Percentiles format, const std::string& label = "", int device = -1) {
+        static const double points[] = {50, 90, 99, 99.9};
+        static const char* names[] = {"p50", "p90", "p99", "p99.9"};
+        const LatencyHistogram* histograms[] = {&latency.wait, &latency.turnaround};
+        const char* kinds[] = {"wait", "turnaround"};
+        const char* text_kinds[] = {"WAIT", "TURNAROUND"};
+        reserve();
+        if (format == SimulationOptions::PERCENTILES_JSON) {
+            used += device < 0 ? snprintf(buffer.get() + used, MAX_LINE, "{") : snprintf(buffer.get() + used, MAX_LINE, "{\"device\":%d,", device);
+            for (int h = 0; h < 2; h++) {
+                used += snprintf(buffer.get() + used, MAX_LINE, "%s\"%s\":{\"count\":%llu", h ? "," : "", kinds[h],
+                                 static_cast<unsigned long long>(histograms[h]->count()));
+                for (int p = 0; p < 4; p++) {
+                    used += snprintf(buffer.get() + used, MAX_LINE, ",\"%s\":%u", names[p], histograms[h]->percentile(points[p]));
+                }
+                used += snprintf(buffer.get() + used, MAX_LINE, ",\"max\":%u}", histograms[h]->max());
+            }
+            used += snprintf(buffer.get() + used, MAX_LINE, "}\n");
+        } else {
+            for (int h = 0; h < 2; h++) {
+                used += snprintf(buffer.get() + used, MAX_LINE, "%s%s:", label.c_str(), text_kinds[h]);
+                for (int p = 0; p < 4; p++) {
+                    used += snprintf(buffer.get() + used, MAX_LINE, " %s %u", names[p], histograms[h]->percentile(points[p]));
+                }
+                used += snprintf(buffer.get() + used, MAX_LINE, " max %u\n", histograms[h]->max());
+            }
+        }
+        flush();
+    }
+    void flush() {
+        if (used > 0) 
+        {
+            out.write(buffer.get(), static_cast<std::streamsize>(used));
+            written += static_cast<long long>(used);
+            used = 0;
+        }
+        out.flush();
+    }
+    long long position() const { return written + static_cast<long long>(used); }
+    //a run resumed from a checkpoint goes on after the output the checkpoint saw 
+    void start_at(long long offset) { written = offset; }
+private:
+    void reserve() {
+        if (CAPACITY - used < MAX_LINE) 
+        {
+            out.write(buffer.get(), static_cast<std::streamsize>(used));
+            written += static_cast<long long>(used);
+            used = 0;
+        }
+    }
+    //right aligns the number in a field of at least 5 characters like setw(5) 
+    static char* write_int(char* pos, long long value) {
+        char digits[21];
+        int count = 0;
+        unsigned long long magnitude = value < 0 ? 0ull - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value);
+        do {
+            digits[count++] = static_cast<char>('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude);
+        if (value < 0) digits[count++] = '-';
+        for (int pad = count; pad < 5; pad++) *pos++ = ' ';
+        while (count) *pos++ = digits[--count];
+        return pos;
+    }
+};
+//what a checkpoint was taken with, resuming with another scheduler or other options
+//would go on with state that doesn't fit. the trace isn't in it, when resuming the
+//next arrival is checked against the one the checkpoint saved 
+static std::string checkpoint_fingerprint(char scheduler_type, const SimulationOptions& options) {
+    CheckpointWriter out;
+    const ServiceModel& model = options.model;
+    out.put(scheduler_type);
+    for (long long value : {static_cast<long long>(options.quiet), static_cast<long long>(options.percentiles),
+                            static_cast<long long>(options.merge_limit), static_cast<long long>(options.queue_depth),
+                            static_cast<long long>(options.queue_rotational), static_cast<long long>(model.seek), model.boundary,
+                            model.settle, model.rotation, model.sectors, static_cast<long long>(model.rank_by_cost), model.rank_window}) {
+        out.put(value);
+    }
+    for (double value : {model.track_time, model.short_base, model.short_sqrt, model.long_base, model.long_track, model.transfer}) {
+        out.put_double(value);
+    }
+    return "IOSCKPT1" + out.data();
+}
+//the checkpoints of one run (-C and -R). the loop asks due() between two events and
+//saves into save() when it says so, which is checked against the clock only every
+//few thousand events so a run without checkpoints or between them doesn't pay for
+//it. a checkpoint file is the fingerprint, how many bytes of output had been written
+//and the state of the simulation. it is written next to the file and renamed over
+//it so a crash while writing leaves the previous checkpoint 
+class Checkpoints {
+private:
+    OutputWriter& writer;
+    std::string path;
+    std::string fingerprint;
+    std::chrono::duration<double> every;
+    std::chrono::steady_clock::time_point last;
+    static const unsigned CHECK_EVERY = 4096;
+    unsigned countdown = CHECK_EVERY;
+    CheckpointWriter state;
+    CheckpointReader resume;
+    bool resuming;
+public:
+    Checkpoints(OutputWriter& writer, char scheduler_type, const SimulationOptions& options)
+            : writer(writer), path(options.checkpoint_path), fingerprint(checkpoint_fingerprint(scheduler_type, options)),
+              every(options.checkpoint_seconds), last(std::chrono::steady_clock::now()), resume(options.resume_state),
+              resuming(!options.resume_state.empty()) {
+        if (resuming) writer.start_at(resume.get());
+    }
+    Checkpoints(const Checkpoints&) = delete;
+    Checkpoints& operator=(const Checkpoints&) = delete;
+    bool due() {
+        if (path.empty() || --countdown > 0) 
+        {
+            return false;
+        }
+        countdown = CHECK_EVERY;
+        return std::chrono::steady_clock::now() - last >= every;
+    }
+    CheckpointWriter& save() {
+        state.clear();
+        return state;
+    }
+    //writes what was saved, after the output up to here so the file never claims more
+    //output than made it out. a checkpoint that can't be written is reported and the
+    //run goes on without checkpoints 
+    void write() {
+        writer.flush();
+        CheckpointWriter offset;
+        offset.put(writer.position());
+        std::string temporary = path + ".tmp";
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out << fingerprint << offset.data() << state.data();
+        out.close();
+        if (!out || std::rename(temporary.c_str(), path.c_str()) != 0) {
+            std::cerr << "Error writing checkpoint: " << path << std::endl;
+            path.clear();
+        }
+        last = std::chrono::steady_clock::now();
+    }
+    //the state to start from when the run resumes, null when it starts from scratch 
+    CheckpointReader* resume_from() { return resuming ? &resume : nullptr; }
+};
+//reads the checkpoint of -R, checks it was taken with the same scheduler and options
+//and puts its state into options. offset is how much output the interrupted run had
+//written. returns an error message, empty on success 
+static std::string load_checkpoint(const std::string& path, char scheduler_type, SimulationOptions& options, long long& offset) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) 
+    {
+        return "Error opening file: " + path;
+    }
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::string fingerprint = checkpoint_fingerprint(scheduler_type, options);
+    if (bytes.compare(0, 8, fingerprint, 0, 8) != 0) 
+    {
+        return "Not a checkpoint: " + path;
+    }
+    if (bytes.compare(0, fingerprint.size(), fingerprint) != 0) 
+    {
+        return "Checkpoint " + path + " was taken with another scheduler or other options";
+    }
+    options.resume_state = bytes.substr(fingerprint.size());
+    CheckpointReader reader(options.resume_state);
+    offset = reader.get();
+    if (reader.failed() || offset < 0) 
+    {
+        return "Corrupt checkpoint: " + path;
+    }
+    return "";
+}
+
+//runs the simulation pulling arrivals from the source as simulated time reaches them.
+//requests only live in the request table from the oldest request that hasn't been
+//printed yet to the newest arrival, finished requests are printed in id order as soon as every
+//request before them is done and the sum line is built from running totals, so
+//memory is bounded by how far requests get reordered and not by the trace length.
+//finished requests go to sink.request(id, arrival, start, end) and the totals into
+//summary, nothing is shared so several simulations can run side by side. the service
+//model of the options decides how long a request takes once the head is free, and
+//the wait and turnaround histograms are only kept if percentiles are printed.
+//telemetry is told about every arrival, dispatch and completion and about every jump
+//in time, NoTelemetry when nobody is recording. start is where time and the head begin,
+//checkpoints are taken or resumed from when given. returns false if the source hit a
+//malformed line or doesn't fit the checkpoint 
+template <typename Scheduler, typename Source, typename Sink, typename Telemetry>
+bool run_simulation(Scheduler& scheduler, Source& source, Sink& sink, SimulationSummary& summary, const SimulationOptions& options,
+                    Telemetry& telemetry, const SimulationStart& start = SimulationStart(), Checkpoints* checkpoints = nullptr) {
+    const ServiceModel& model = options.model;
+    //helper variable declaration/intialization
+    //requests that arrived but have not been printed yet, front has the lowest id 
+    RequestTable requests;
+    //the next request in the source that hasn't arrived yet 
+    TraceEntry upcoming;
+    bool has_upcoming = source.next(upcoming);
+    //track variable to keep track of current_time 
+    long long current_time = start.time;
+    //track variable to keep track of current request
+    int current_track = start.track;
+    //track variable to keep track of active request
+    RequestId active_request = NO_REQUEST;
+    //where the head is once the active request is done, further than its track if
+    //requests were merged into it 
+    int active_track = 0;
+    //with -M the requests that arrived and wait in the scheduler by track, and the
+    //ones merged into the active request that finish together with it 
+    const bool merging = options.merge_limit > 1;
+    const std::size_t merge_limit = static_cast<std::size_t>(std::max(options.merge_limit, 1));
+    TrackIndex waiting;
+    std::vector<RequestId> merged;
+    //running totals for the sum line, including total movement of disk head 
+    summary = SimulationSummary();
+    if (options.percentiles != SimulationOptions::PERCENTILES_OFF) 
+    {
+        summary.latency.reset(new LatencyStats());
+    }
+    LatencyStats* latency = summary.latency.get();
+    //what a scheduler that looks past the track sees 
+    DispatchState dispatch{&requests, 0};
+    scheduler.attach(&dispatch);
+    if (model.rank_by_cost) 
+    {
+        scheduler.rank_by_model(&model, &dispatch);
+    }
+    //with -Q the command queue of the disk, which orders by track like SSTF or by
+    //positioning time like SSTF ranking by the model, either way without a scan 
+    const std::size_t queue_depth = static_cast<std::size_t>(std::max(options.queue_depth, 0));
+    SSTFScheduler device;
+    std::size_t device_queued = 0;
+    if (options.queue_rotational) 
+    {
+        device.rank_by_model(&model, &dispatch);
+    }
+    //adds a finished request to the totals, the disk was only busy once for all the
+    //requests of a merged operation 
+    auto account = [&](RequestId request, bool busy) {
+        long long arrival_time = requests.arrival_time(request);
+        long long start_time = requests.start_time(request);
+        long long end_time = requests.end_time(request);
+        if (busy) summary.busy_time += end_time - start_time;
+        summary.total_turnaround += end_time - arrival_time;
+        summary.total_wait_time += start_time - arrival_time;
+        summary.max_wait_time = std::max(summary.max_wait_time, start_time - arrival_time);
+        summary.completed++;
+        telemetry.completed(start_time - arrival_time);
+        if (latency != nullptr) 
+        {
+            latency->wait.record(start_time - arrival_time);
+            latency->turnaround.record(end_time - arrival_time);
+        }
+    };
+    //prints every request at the front of the table that is finished so output stays
+    //ordered by id 
+    auto release = [&]() {
+        while (!requests.empty() && requests.start_time(requests.front()) != -1 && requests.end_time(requests.front()) <= current_time
+               && requests.front() != active_request) {
+            RequestId id = requests.front();
+            sink.request(requests.index(id), requests.arrival_time(id), requests.start_time(id), requests.end_time(id));
+            requests.pop_front();
+        }
+    };
+    //the active operation is done, the head is where it ended 
+    auto complete = [&]() {
+        current_track = active_track;
+        RequestId done = active_request;
+        active_request = NO_REQUEST;
+        for (RequestId id : merged) account(id, false);
+        merged.clear();
+        account(done, true);
+        release();
+    };
+    //like a block layer merge, takes the waiting requests on the track of the request
+    //being dispatched and then on each following track in the direction the head
+    //moves out of the scheduler so they are served in the same operation without
+    //another seek. stops at a track without requests or at the limit, returns the
+    //extra time the operation takes to go on to them 
+    auto merge = [&](RequestId leader) {
+        int target = requests.track(leader);
+        waiting.erase(TrackIndex::key(target, leader));
+        long long step = target >= current_track ? 1 : -1;
+        long long extra = 0;
+        int previous = target;
+        for (long long track = target; merged.size() + 1 < merge_limit; track += step) {
+            if (track > std::numeric_limits<int>::max() || track < std::numeric_limits<int>::min()) break;
+            bool found = false;
+            std::uint64_t key = waiting.at_or_above(static_cast<int>(track));
+            while (key != TrackIndex::NONE && TrackIndex::track_of(key) == track && merged.size() + 1 < merge_limit) {
+                std::uint64_t next = waiting.after(key);
+                RequestId id = TrackIndex::id_of(key);
+                if (scheduler.remove_request(id, static_cast<int>(track))) {
+                    waiting.erase(key);
+                    merged.push_back(id);
+                    telemetry.dispatched();
+                    std::uint32_t hop = static_cast<std::uint32_t>(track - previous) * static_cast<std::uint32_t>(step);
+                    extra += model.plain ? hop : model.seek_time(hop) + std::llround(model.transfer * requests.size(id));
+                    previous = static_cast<int>(track);
+                    found = true;
+                }
+                key = next;
+            }
+            if (!found && track != target) break;
+        }
+        summary.total_movement += std::abs(static_cast<long long>(previous) - target);
+        summary.merged += static_cast<long long>(merged.size());
+        active_track = previous;
+        return extra;
+    };
+    //the scheduler hands requests to the disk until its queue is full, the one being
+    //served included. it doesn't know where the head will be when the disk gets to
+    //them so it goes by where it is now 
+    auto fill_device = [&]() {
+        while (device_queued + (active_request != NO_REQUEST) < queue_depth) {
+            dispatch.now = current_time;
+            RequestId id = scheduler.get_next_request(current_track);
+            if (id == NO_REQUEST) 
+            {
+                break;
+            }
+            device.add_request(id, requests.track(id));
+            device_queued++;
+        }
+    };
+    //the request the head serves next, picked by the disk out of its queue with -Q 
+    auto next_request = [&]() {
+        dispatch.now = current_time;
+        if (queue_depth == 0) 
+        {
+            return scheduler.get_next_request(current_track);
+        }
+        fill_device();
+        RequestId id = device.get_next_request(current_track);
+        if (id != NO_REQUEST) device_queued--;
+        return id;
+    };
+    //where the head is at a time before the next event, during a request it moves
+    //evenly from the previous track to the requests track over its service time,
+    //which is exact for the default one track per time unit 
+    auto head_at = [&](long long time) {
+        if (active_request == NO_REQUEST) 
+        {
+            return current_track;
+        }
+        long long from = current_track, to = active_track;
+        long long start = requests.start_time(active_request), end = requests.end_time(active_request);
+        if (time >= end || end == start) 
+        {
+            return static_cast<int>(to);
+        }
+        return static_cast<int>(from + (to - from) * (time - start) / (end - start));
+    };
+    //everything above that outlives an iteration of the loop, saved at its top before
+    //the arrivals up to the current time are added. the next arrival is saved too so a
+    //resumed run can tell whether it reads the same input 
+    auto save = [&](CheckpointWriter& out) {
+        out.put(current_time);
+        out.put(current_track);
+        out.put(active_request == NO_REQUEST ? -1 : static_cast<long long>(active_request));
+        out.put(active_track);
+        out.put(static_cast<long long>(merged.size()));
+        for (RequestId id : merged) out.put(id);
+        waiting.save(out);
+        device.save_state(out);
+        out.put(static_cast<long long>(device_queued));
+        summary.save(out);
+        requests.save(out);
+        scheduler.save_state(out);
+        out.put(has_upcoming);
+        if (has_upcoming) 
+        {
+            out.put(upcoming.arrival_time);
+            for (int value : {upcoming.track, upcoming.sector, upcoming.size, upcoming.write, upcoming.stream}) out.put(value);
+        }
+    };
+    if (checkpoints != nullptr && checkpoints->resume_from() != nullptr) {
+        CheckpointReader& in = *checkpoints->resume_from();
+        current_time = in.get();
+        current_track = static_cast<int>(in.get());
+        long long active = in.get();
+        active_request = active < 0 ? NO_REQUEST : static_cast<RequestId>(active);
+        active_track = static_cast<int>(in.get());
+        std::size_t count = in.get_count();
+        for (std::size_t i = 0; i < count; i++) merged.push_back(static_cast<RequestId>(in.get()));
+        waiting.load(in);
+        device.load_state(in);
+        device_queued = static_cast<std::size_t>(in.get());
+        summary.load(in);
+        requests.load(in);
+        scheduler.load_state(in);
+        //the source starts from the beginning again, skip what was read before the checkpoint 
+        for (std::uint64_t read = 1; has_upcoming && read <= requests.added(); read++) has_upcoming = source.next(upcoming);
+        bool saved_upcoming = in.get() != 0;
+        bool same = saved_upcoming == has_upcoming;
+        if (saved_upcoming) 
+        {
+            same = same && in.get() == upcoming.arrival_time;
+            for (int value : {upcoming.track, upcoming.sector, upcoming.size, upcoming.write, upcoming.stream}) same = same && in.get() == value;
+        }
+        if (in.failed() || !in.at_end() || !same) {
+            std::cerr << (source.failed() ? "" : "Checkpoint doesn't match the input\n");
+            return false;
+        }
+    }
+    //the loop used to follow the pseudocode from the directions literally and step
+    //current_time by one unit per iteration, moving the head one track at a time.
+    //that made the runtime grow with total_time and seek distance instead of with
+    //the number of requests, so now we only stop at the times where something can
+    //actually happen: the next arrival or the completion of the active request.
+    //the head only matters to the scheduler when we dispatch and we only dispatch
+    //when nothing is active, so we can account a whole seek at once
+    while (true) {
+        if (checkpoints != nullptr && checkpoints->due()) 
+        {
+            save(checkpoints->save());
+            checkpoints->write();
+        }
+        //the ids run out in a long live run, the requests in flight get new ones 
+        if (requests.renumber_due()) {
+            RequestId offset = requests.renumber();
+            if (active_request != NO_REQUEST) active_request -= offset;
+            for (RequestId& id : merged) id -= offset;
+            waiting.renumber(offset);
+            device.renumber(offset);
+            scheduler.renumber(offset);
+        }
+        //add every request that has arrived by the current time to the scheduler.
+        //using <= instead of == so an unsorted arrival can't stall the loop forever
+        while (has_upcoming && upcoming.arrival_time <= current_time) 
+        {
+            RequestId id = requests.add(upcoming.arrival_time, upcoming.track, upcoming.sector, upcoming.size, upcoming.write, upcoming.stream);
+            scheduler.add_request(id, upcoming.track);
+            if (merging) waiting.insert(id, upcoming.track);
+            telemetry.arrived();
+            has_upcoming = source.next(upcoming);
+        }
+        //the disk takes new requests into its queue while it is busy 
+        if (queue_depth > 0) 
+        {
+            fill_device();
+        }
+
+        //if the active request finishes exactly now it is complete 
+        if (active_request != NO_REQUEST && requests.end_time(active_request) == current_time) 
+        {
+            //head has now arrived at the requests track
+            complete();
+        }
+        //keep dispatching while the head is free, a request that is already at the
+        //current track finishes at the same time so we immediately ask for another one
+        while (active_request == NO_REQUEST) {
+            active_request = next_request();
+            //scheduler has nothing pending
+            if (active_request == NO_REQUEST) 
+            {
+                break;
+            }
+            telemetry.dispatched();
+            //intialize its start and end time according to our current track and track the requests 
+            //wants to get to 
+            int distance = std::abs(requests.track(active_request) - current_track);
+            long long service_time = model.plain ? distance
+                                   : model.service_time(static_cast<std::uint32_t>(distance), requests.sector(active_request),
+                                                        requests.size(active_request), current_time);
+            active_track = requests.track(active_request);
+            if (merging) service_time += merge(active_request);
+            requests.start_time(active_request) = current_time;
+            requests.end_time(active_request) = current_time + service_time;
+            for (RequestId id : merged) {
+                requests.start_time(id) = current_time;
+                requests.end_time(id) = current_time + service_time;
+            }
+            //the whole seek is accounted for here instead of one track per time unit
+            summary.total_movement += distance;
+            if (service_time == 0) 
+            {
+                complete();
+            }
+        }
+        //if we don't have any active requests and we have reached the end of our
+        //input this implies we have processed all of them so break 
+        if (active_request == NO_REQUEST && !has_upcoming) {
+            break;
+        }
+        //jump straight to the next event, either the completion of the active request
+        //or the next arrival whichever comes first 
+        long long next_time = std::numeric_limits<long long>::max();
+        if (active_request != NO_REQUEST) 
+        {
+            next_time = requests.end_time(active_request);
+        }
+        if (has_upcoming) 
+        {
+            next_time = std::min(next_time, upcoming.arrival_time);
+        }
+        telemetry.advance(next_time, head_at);
+        current_time = next_time;
+    }
+    //a malformed line ends the input early, don't report a sum for half a trace 
+    if (source.failed()) 
+    {
+        return false;
+    }
+    telemetry.finish(current_time, head_at);
+    //set the total time once we break the loop since now we have finishde with scheduling 
+    summary.total_time = current_time;
+    summary.final_track = current_track;
+    return true;
+}
+//telemetry hooks of the simulation loop that compile to nothing, used whenever -T is
+//not given so the loop has no extra work at all 
+struct NoTelemetry {
+    void arrived() {}
+    void dispatched() {}
+    void completed(long long) {}
+    template <typename Head>
+    void advance(long long, Head&) {}
+    template <typename Head>
+    void finish(long long, Head&) {}
+};
+//records the state of the simulation at every multiple of the interval: requests
+//waiting in the scheduler, where the head is, whether a request is being served and
+//how many completed since the previous sample. the loop only stops at events so the
+//samples between two events are all written when it jumps over them, the state
+//can't change in between except for the head which head(time) works out 
+class TelemetryRecorder {
+private:
+    std::ofstream out;
+    bool binary;
+    long long interval;
+    long long next_sample = 0;
+    std::uint32_t depth = 0;
+    std::uint32_t window = 0;
+    bool active = false;
+    std::unique_ptr<char[]> buffer;
+    std::size_t used = 0;
+    static const std::size_t CAPACITY = 1 << 16;
+    static const std::size_t MAX_RECORD = 96;
+    //fixed size little endian record of the binary format, after a header of the
+    //8 byte magic and the interval as an int64 
+    struct Record {
+        std::int64_t time;
+        std::uint32_t queue_depth;
+        std::int32_t head_track;
+        std::uint32_t active;
+        std::uint32_t completed;
+    };
+    void flush() {
+        out.write(buffer.get(), static_cast<std::streamsize>(used));
+        used = 0;
+    }
+    void sample(long long time, int head) {
+        if (used + MAX_RECORD > CAPACITY) flush();
+        if (binary) {
+            Record record{time, depth, head, active, window};
+            std::memcpy(buffer.get() + used, &record, sizeof(record));
+            used += sizeof(record);
+        } else {
+            used += snprintf(buffer.get() + used, MAX_RECORD, "%lld,%u,%d,%d,%u\n", time, depth, head, active ? 1 : 0, window);
+        }
+        window = 0;
+    }
+public:
+    TelemetryRecorder(const std::string& path, long long interval)
+            : out(path, std::ios::binary), interval(interval), buffer(new char[CAPACITY]) {
+        binary = path.size() >= 4 && path.compare(path.size() - 4, 4, ".bin") == 0;
+        if (binary) {
+            std::int64_t header_interval = interval;
+            out.write("IOSTEL01", 8);
+            out.write(reinterpret_cast<const char*>(&header_interval), sizeof(header_interval));
+        } else {
+            out << "time,queue_depth,head_track,active,completed\n";
+        }
+    }
+    TelemetryRecorder(const TelemetryRecorder&) = delete;
+    TelemetryRecorder& operator=(const TelemetryRecorder&) = delete;
+    ~TelemetryRecorder() { flush(); }
+    bool is_open() const { return out.is_open(); }
+    void arrived() { depth++; }
+    void dispatched() {
+        depth--;
+        active = true;
+    }
+    void completed(long long) {
+        window++;
+        active = false;
+    }
+    //the loop is about to jump to time, write the samples before it 
+    template <typename Head>
+    void advance(long long time, Head& head) {
+        for (; next_sample < time; next_sample += interval) sample(next_sample, head(next_sample));
+    }
+    //the run ended at time, write the samples up to and including it 
+    template <typename Head>
+    void finish(long long time, Head& head) {
+        advance(time + 1, head);
+    }
+};
+//input of the live mode. lines are read from a stream that may still be written to,
+//and whatever has been printed so far is flushed before a read that would wait for
+//more, so a finished request shows up as soon as an arrival after its end was read.
+//requests may arrive up to window time units after a later one, they are held back in
+//a heap until a request window units newer than them was read and come out sorted by
+//arrival (in input order on a tie). the heap only holds one window of requests. one
+//that arrives even later could already be behind requests that were let out, so it
+//ends the input like a malformed line instead of skewing the waits without a sign 
+class LiveSource {
+private:
+    struct Held {
+        long long arrival_time;
+        std::uint64_t order;
+        TraceEntry entry;
+        bool operator<(const Held& other) const {
+            return arrival_time != other.arrival_time ? arrival_time > other.arrival_time : order > other.order;
+        }
+    };
+    TraceReader& reader;
+    std::istream& in;
+    OutputWriter& writer;
+    long long window;
+    std::priority_queue<Held> held;
+    std::uint64_t read = 0;
+    long long newest = std::numeric_limits<long long>::min();
+    bool done = false;
+    bool late = false;
+public:
+    LiveSource(TraceReader& reader, std::istream& in, OutputWriter& writer, long long window)
+            : reader(reader), in(in), writer(writer), window(window) {}
+    bool next(TraceEntry& entry) {
+        while (!done && (held.empty() || newest - held.top().arrival_time < window)) {
+            if (in.rdbuf()->in_avail() <= 0) writer.flush();
+            TraceEntry incoming;
+            if (!reader.next(incoming)) 
+            {
+                done = true;
+                break;
+            }
+            if (read > 0 && newest - incoming.arrival_time > window) 
+            {
+                late = true;
+                done = true;
+                break;
+            }
+            held.push({incoming.arrival_time, read++, incoming});
+            newest = std::max<long long>(newest, incoming.arrival_time);
+        }
+        if (held.empty()) 
+        {
+            return false;
+        }
+        entry = held.top().entry;
+        held.pop();
+        return true;
+    }
+    bool failed() const { return reader.failed() || late; }
+    std::string error() const {
+        return late ? reader.problem("Arrival older than the reorder window on input line ") : reader.error();
+    }
+};
+//telemetry hooks of the live mode, a sum line labeled SUM@<time> for the requests that
+//completed in the interval up to time. the interval is in the total time column and the
+//utilization is how much of it the disk was busy. intervals where nothing completed are
+//skipped. the other totals are the difference of the running ones to the last line, so
+//only the longest wait and the busy time are kept here. the movement is counted when a
+//request is dispatched, so the window takes it as it was at its last completion and an
+//operation still under way counts in the window it completes in like everything else.
+//dispatches and completions happen at the time the loop last jumped to 
+class LiveSnapshots {
+private:
+    OutputWriter& writer;
+    const SimulationSummary& summary;
+    long long interval;
+    long long next_snapshot;
+    SimulationSummary last;
+    long long max_wait_time = 0;
+    long long now = 0;
+    long long interval_start = 0;
+    long long busy_time = 0;
+    //total movement of the operations that completed so far 
+    long long completed_movement = 0;
+    //start of the operation the head is busy with 
+    bool active = false;
+    long long active_start = 0;
+    void snapshot(long long time) {
+        if (active) busy_time += time - std::max(active_start, interval_start);
+        interval_start = time;
+        if (summary.completed == last.completed) 
+        {
+            busy_time = 0;
+            return;
+        }
+        SimulationSummary window;
+        window.total_time = interval;
+        window.total_movement = completed_movement - last.total_movement;
+        window.busy_time = busy_time;
+        window.total_turnaround = summary.total_turnaround - last.total_turnaround;
+        window.total_wait_time = summary.total_wait_time - last.total_wait_time;
+        window.max_wait_time = max_wait_time;
+        window.completed = summary.completed - last.completed;
+        writer.sum(window, "SUM@" + std::to_string(time));
+        last.total_movement = completed_movement;
+        last.total_turnaround = summary.total_turnaround;
+        last.total_wait_time = summary.total_wait_time;
+        last.completed = summary.completed;
+        max_wait_time = 0;
+        busy_time = 0;
+    }
+public:
+    LiveSnapshots(OutputWriter& writer, const SimulationSummary& summary, long long interval)
+            : writer(writer), summary(summary), interval(interval), next_snapshot(interval) {}
+    void arrived() {}
+    //merged requests are dispatched and completed with the operation they are part of 
+    void dispatched() {
+        if (!active) active_start = now;
+        active = true;
+    }
+    void completed(long long wait_time) {
+        max_wait_time = std::max(max_wait_time, wait_time);
+        completed_movement = summary.total_movement;
+        if (active) busy_time += now - std::max(active_start, interval_start);
+        active = false;
+    }
+    //the loop is about to jump to time, everything up to the snapshots before it happened 
+    template <typename Head>
+    void advance(long long time, Head&) {
+        if (interval > 0) {
+            //a long idle stretch is skipped in one step instead of interval by interval 
+            if (summary.completed == last.completed && !active && next_snapshot < time) next_snapshot += (time - next_snapshot) / interval * interval;
+            for (; next_snapshot < time; next_snapshot += interval) snapshot(next_snapshot);
+        }
+        now = time;
+    }
+    template <typename Head>
+    void finish(long long, Head&) {}
+};
+//the lines after the requests, the sum line and the merge and percentile lines when
+//they were asked for 
+static void write_totals(OutputWriter& writer, const SimulationSummary& summary, const SimulationOptions& options) {
+    //print out our final sum line for the ouput 
+    writer.sum(summary);
+    if (options.merge_limit > 1) 
+    {
+        writer.merges(summary);
+    }
+    if (summary.latency) 
+    {
+        writer.percentiles(*summary.latency, options.percentiles);
+    }
+}
+//runs the simulation and prints every request in id order and the sum line to out.
+//scheduler_type is the letter checkpoints are taken and resumed under. returns false
+//without the sum line if the source hit a malformed line 
+template <typename Scheduler, typename Source>
+bool simulate_io_scheduler(Scheduler& scheduler, Source& source, std::ostream& out, const SimulationOptions& options, char scheduler_type = 0) {
+    OutputWriter writer(out, options.quiet);
+    SimulationSummary summary;
+    Checkpoints checkpoints(writer, scheduler_type, options);
+    bool ok;
+    if (options.telemetry_interval > 0) {
+        TelemetryRecorder telemetry(options.telemetry_path, options.telemetry_interval);
+        if (!telemetry.is_open()) std::cerr << "Error opening file: " << options.telemetry_path << std::endl;
+        ok = run_simulation(scheduler, source, writer, summary, options, telemetry, SimulationStart(), &checkpoints);
+    } else {
+        NoTelemetry telemetry;
+        ok = run_simulation(scheduler, source, writer, summary, options, telemetry, SimulationStart(), &checkpoints);
+    }
+    if (!ok) 
+    {
+        return false;
+    }
+    write_totals(writer, summary, options);
+    return true;
+}
+template <typename... Schedulers>
+struct SchedulerRegistry {
+    static bool known(char letter) {
+        return ((letter == Schedulers::letter) || ...);
+    }
+    //every letter in registration order, what -sall expands to 
+    static std::string letters() {
+        return std::string{Schedulers::letter...};
+    }
+    //creates the scheduler registered for the letter on the stack and calls body with
+    //it, so body is instantiated for the exact scheduler type. returns what body
+    //returned, false if there is no such scheduler 
+    template <typename Body>
+    static bool with_scheduler(char letter, Body&& body) {
+        bool ok = false;
+        ((letter == Schedulers::letter && (ok = call<Schedulers>(body), true)) || ...);
+        return ok;
+    }
+    //runs the simulation with the scheduler registered for the letter, returns false
+    //if the source failed or there is no such scheduler 
+    template <typename Source>
+    static bool run(char letter, Source& source, std::ostream& out, const SimulationOptions& options) {
+        return with_scheduler(letter, [&](auto& scheduler) {
+            return simulate_io_scheduler(scheduler, source, out, options, letter);
+        });
+    }
+private:
+    template <typename Scheduler, typename Body>
+    static bool call(Body& body) {
+        Scheduler scheduler;
+        return body(scheduler);
+    }
+};
+//every scheduler the simulator knows, adding a policy is adding its class here. each
+//class names the option letter it is registered under in its static letter.
+//N is for FIFO, S is for SSTF, L is for LOOK, C is for CLOOK, F is for FLOOK, D is for
+//mq-deadline and B is for BFQ 
+using Schedulers = SchedulerRegistry<FIFOScheduler, SSTFScheduler, LOOKScheduler, CLOOKScheduler, FLOOKScheduler, DeadlineScheduler, BFQScheduler>;
+//runs tasks 0 to count-1 on a pool of threads. every worker starts out with its own
+//share of the tasks and takes them from the back of its deque, once it runs dry it
+//steals from the front of another workers deque so a few long traces at the end
+//don't leave the other cores idle. no task adds new tasks so a worker that finds
+//every deque empty is done 
+template <typename Task>
+void run_work_stealing(std::size_t count, unsigned threads, Task task) {
+    struct WorkQueue {
+        std::mutex lock;
+        std::deque<std::size_t> tasks;
+    };
+    threads = std::max(1u, std::min<unsigned>(threads, std::max<std::size_t>(count, 1)));
+    std::vector<WorkQueue> queues(threads);
+    for (std::size_t i = 0; i < count; i++) {
+        queues[i % threads].tasks.push_back(i);
+    }
+    auto worker = [&](unsigned self) {
+        while (true) {
+            std::size_t next = 0;
+            bool found = false;
+            //own work first, newest end 
+            {
+                std::lock_guard<std::mutex> guard(queues[self].lock);
+                if (!queues[self].tasks.empty()) {
+                    next = queues[self].tasks.back();
+                    queues[self].tasks.pop_back();
+                    found = true;
+                }
+            }
+            //then steal the oldest task from the next worker that has any 
+            for (unsigned i = 1; !found && i < threads; i++) {
+                WorkQueue& victim = queues[(self + i) % threads];
+                std::lock_guard<std::mutex> guard(victim.lock);
+                if (!victim.tasks.empty()) {
+                    next = victim.tasks.front();
+                    victim.tasks.pop_front();
+                    found = true;
+                }
+            }
+            if (!found) 
+            {
+                return;
+            }
+            task(next);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < threads; i++) {
+        pool.emplace_back(worker, i);
+    }
+    //the calling thread is a worker too 
+    worker(0);
+    for (auto& thread : pool) {
+        thread.join();
+    }
+}
+//runs every scheduler in the list over the same loaded trace, each one on its own
+//thread. the trace is shared read only since every run keeps its own request state,
+//and the outputs are printed in the order the schedulers were given once all are done 
+static void run_sweep(const std::string& scheduler_types, const std::vector<TraceEntry>& trace, const SimulationOptions& options) {
+    std::vector<std::ostringstream> outputs(scheduler_types.size());
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < scheduler_types.size(); i++) {
+        threads.emplace_back([&, i]() {
+            TraceArraySource source(trace);
+            //every scheduler samples into its own file, <file>.<letter> 
+            SimulationOptions own = options;
+            if (own.telemetry_interval > 0) own.telemetry_path += std::string(".") + scheduler_types[i];
+            Schedulers::run(scheduler_types[i], source, outputs[i], own);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (std::size_t i = 0; i < scheduler_types.size(); i++) {
+        std::cout << "SCHEDULER: " << scheduler_types[i] << std::endl;
+        std::cout << outputs[i].str();
+    }
+}
+//simulates an array of disks. the loaded trace is routed into one trace per disk and
+//every disk gets its own scheduler and head, so the disks don't depend on each other
+//and run on the work stealing pool. the requests are printed by their id in the
+//whole trace, then a sum line per disk and the sum over the array where utilization
+//is the busy share of all the disks over the total time 
+static int run_multi_disk(char scheduler_type, const std::vector<TraceEntry>& trace, unsigned threads, const SimulationOptions& options) {
+    const DeviceRouting& routing = options.routing;
+    std::vector<std::vector<TraceEntry>> device_traces(routing.devices);
+    //the id of every request of a disk in the whole trace 
+    std::vector<std::vector<std::uint32_t>> global_ids(routing.devices);
+    for (std::size_t i = 0; i < trace.size(); i++) {
+        TraceEntry entry = trace[i];
+        if (!routing.route(entry)) {
+            std::cerr << "Device " << entry.device << " of request " << i << " is not in the array" << std::endl;
+            return 1;
+        }
+        device_traces[entry.device].push_back(entry);
+        global_ids[entry.device].push_back(static_cast<std::uint32_t>(i));
+    }
+    //every disk writes the times of its own requests, no two disks share an id 
+    struct DeviceSink {
+        const std::uint32_t* global_id;
+        long long* start_time;
+        long long* end_time;
+        void request(long long id, long long, long long start, long long end) {
+            start_time[global_id[id]] = start;
+            end_time[global_id[id]] = end;
+        }
+    };
+    std::vector<long long> start_time(trace.size()), end_time(trace.size());
+    std::vector<SimulationSummary> summaries(routing.devices);
+    run_work_stealing(routing.devices, threads, [&](std::size_t device) {
+        TraceArraySource source(device_traces[device]);
+        DeviceSink sink{global_ids[device].data(), start_time.data(), end_time.data()};
+        Schedulers::with_scheduler(scheduler_type, [&](auto& scheduler) {
+            //every disk samples into its own file, <file>.<device> 
+            if (options.telemetry_interval > 0) {
+                std::string path = options.telemetry_path + "." + std::to_string(device);
+                TelemetryRecorder telemetry(path, options.telemetry_interval);
+                if (!telemetry.is_open()) std::cerr << "Error opening file: " << path << std::endl;
+                return run_simulation(scheduler, source, sink, summaries[device], options, telemetry);
+            }
+            NoTelemetry telemetry;
+            return run_simulation(scheduler, source, sink, summaries[device], options, telemetry);
+        });
+    });
+    OutputWriter writer(std::cout, options.quiet);
+    for (std::size_t i = 0; i < trace.size(); i++) {
+        writer.request(static_cast<int>(i), trace[i].arrival_time, start_time[i], end_time[i]);
+    }
+    SimulationSummary total;
+    total.devices = routing.devices;
+    for (int device = 0; device < routing.devices; device++) {
+        writer.sum(summaries[device], "DEVICE " + std::to_string(device) + " SUM");
+        if (options.merge_limit > 1) writer.merges(summaries[device], "DEVICE " + std::to_string(device) + " ");
+        if (summaries[device].latency) 
+        {
+            writer.percentiles(*summaries[device].latency, options.percentiles, "DEVICE " + std::to_string(device) + " ", device);
+        }
+        total.add(summaries[device]);
+    }
+    writer.sum(total);
+    if (options.merge_limit > 1) writer.merges(total);
+    if (total.latency) 
+    {
+        writer.percentiles(*total.latency, options.percentiles);
+    }
+    return 0;
+}
+//cuts a loaded trace into about `pieces` pieces for the parallel mode. near every even
+//share of the requests the cut goes before the request that follows the longest gap
+//in the arrivals, which is where the queue most likely ran dry, and a share without
+//any gap isn't cut. returns the first request of every piece and the trace size 
+static std::vector<std::size_t> split_points(const std::vector<TraceEntry>& trace, std::size_t pieces) {
+    std::vector<std::size_t> cuts{0};
+    std::size_t window = std::max<std::size_t>(1, trace.size() / pieces / 4);
+    //latest arrival before request i, the disk can only be idle when i arrives if
+    //i comes after all of them 
+    long long latest = std::numeric_limits<long long>::min();
+    std::size_t i = 0;
+    for (std::size_t piece = 1; piece < pieces; piece++) {
+        std::size_t target = trace.size() * piece / pieces;
+        std::size_t low = target > window ? target - window : 0;
+        std::size_t high = std::min(trace.size(), target + window);
+        std::size_t best = 0;
+        long long best_gap = 0;
+        for (; i < high; i++) {
+            if (i >= low && i > cuts.back() && trace[i].arrival_time - latest > best_gap) {
+                best = i;
+                best_gap = trace[i].arrival_time - latest;
+            }
+            latest = std::max<long long>(latest, trace[i].arrival_time);
+        }
+        if (best_gap > 0) cuts.push_back(best);
+    }
+    cuts.push_back(trace.size());
+    return cuts;
+}
+//one piece of the trace in the parallel mode, the requests from begin up to end run
+//from start with the scheduler in the idle state `state`, and how it ended 
+struct PieceRun {
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    SimulationStart start;
+    std::vector<long long> state;
+    SimulationSummary summary;
+    std::vector<long long> final_state;
+};
+//simulates a loaded trace in pieces on the work stealing pool. if the disk was idle
+//when a piece arrived, all it takes over from the piece before is the time, the head
+//track and the idle state of the scheduler, so each piece but the first starts from a
+//guess of those: the last WARMUP requests before it are run through a fresh scheduler
+//and where they leave the head and the scheduler is the guess. then the pieces are
+//checked in order against how the one before really ended. a piece that guessed wrong
+//runs again from the real state, and if the piece before was still busy when it
+//arrived the two run again as one, so the result is always that of a single run.
+//the times of every request go to start_time and end_time by id and the totals into
+//total. returns how many pieces had to run again 
+static std::size_t simulate_split(char scheduler_type, const std::vector<TraceEntry>& trace, std::size_t pieces, unsigned threads,
+                                  const SimulationOptions& options, std::vector<long long>& start_time, std::vector<long long>& end_time,
+                                  SimulationSummary& total) {
+    const std::size_t WARMUP = 1024;
+    std::vector<std::size_t> cuts = split_points(trace, pieces);
+    std::vector<PieceRun> runs(cuts.size() - 1);
+    std::size_t reruns = 0;
+    Schedulers::with_scheduler(scheduler_type, [&](auto& scheduler) {
+        typedef std::decay_t<decltype(scheduler)> Scheduler;
+        //a piece writes the times of its requests by their id in the whole trace, the
+        //warm up runs don't write anything 
+        struct PieceSink {
+            std::size_t offset;
+            long long* start_time;
+            long long* end_time;
+            void request(long long id, long long, long long start, long long end) {
+                if (start_time == nullptr) return;
+                start_time[offset + id] = start;
+                end_time[offset + id] = end;
+            }
+        };
+        auto simulate = [&](PieceRun& run, long long* starts, long long* ends) {
+            Scheduler own;
+            own.load_idle(run.state);
+            TraceArraySource source(trace, run.begin, run.end);
+            PieceSink sink{run.begin, starts, ends};
+            NoTelemetry telemetry;
+            run_simulation(own, source, sink, run.summary, options, telemetry, run.start);
+            run.final_state.clear();
+            own.save_idle(run.final_state);
+        };
+        run_work_stealing(runs.size(), threads, [&](std::size_t piece) {
+            PieceRun& run = runs[piece];
+            run.begin = cuts[piece];
+            run.end = cuts[piece + 1];
+            if (piece > 0) {
+                PieceRun warmup;
+                warmup.begin = std::max(cuts[piece - 1], run.begin - std::min(run.begin, WARMUP));
+                warmup.end = run.begin;
+                warmup.start.time = trace[warmup.begin].arrival_time;
+                Scheduler().save_idle(warmup.state);
+                simulate(warmup, nullptr, nullptr);
+                run.start.time = trace[run.begin].arrival_time;
+                run.start.track = warmup.summary.final_track;
+                run.state = warmup.final_state;
+            } else {
+                Scheduler().save_idle(run.state);
+            }
+            simulate(run, start_time.data(), end_time.data());
+        });
+        PieceRun* current = &runs[0];
+        //how many pieces a run that is still busy takes in, doubles every time it
+        //happens in a row so a trace that is never idle costs a few single runs and
+        //not one per piece 
+        std::size_t stretch = 1;
+        for (std::size_t piece = 1; piece < runs.size();) {
+            PieceRun& next = runs[piece];
+            //the piece before has to be done strictly before this one starts. finishing
+            //at its first arrival isn't enough, the piece before asked its scheduler for
+            //work at that time and found none, which a scheduler like BFQ takes as the end
+            //of the active streams budget, while the whole trace queues the arrival first 
+            bool idle = current->summary.total_time < next.start.time;
+            if (idle && current->summary.final_track == next.start.track && current->final_state == next.state) {
+                total.add(current->summary);
+                current = &next;
+                stretch = 1;
+                piece++;
+                continue;
+            }
+            reruns++;
+            if (idle) {
+                next.start.track = current->summary.final_track;
+                next.state = current->final_state;
+                total.add(current->summary);
+                simulate(next, start_time.data(), end_time.data());
+                current = &next;
+                stretch = 1;
+                piece++;
+            } else {
+                //the piece before goes on into this one and the ones after it 
+                std::size_t last = std::min(runs.size(), piece + stretch) - 1;
+                current->end = runs[last].end;
+                simulate(*current, start_time.data(), end_time.data());
+                piece = last + 1;
+                stretch *= 2;
+            }
+        }
+        total.add(current->summary);
+        return true;
+    });
+    return reruns;
+}
+//the parallel mode, prints exactly what one run over the whole trace prints 
+static int run_split(char scheduler_type, const std::vector<TraceEntry>& trace, unsigned threads, const SimulationOptions& options) {
+    std::vector<long long> start_time(trace.size()), end_time(trace.size());
+    SimulationSummary total;
+    simulate_split(scheduler_type, trace, static_cast<std::size_t>(options.pieces), threads, options, start_time, end_time, total);
+    OutputWriter writer(std::cout, options.quiet);
+    for (std::size_t i = 0; i < trace.size(); i++) {
+        writer.request(static_cast<int>(i), trace[i].arrival_time, start_time[i], end_time[i]);
+    }
+    write_totals(writer, total, options);
+    return 0;
+}
+//reads the trace from the reader and runs the simulation, unless we stream we load
+//the whole trace first so a bad input is reported before anything is simulated.
+//with more than one scheduler the loaded trace is swept by all of them in parallel 
+template <typename Reader>
+int run_trace(const std::string& scheduler_types, Reader& reader, bool stream, unsigned threads, const SimulationOptions& options) {
+    //check the scheduler letters before reading anything 
+    for (char scheduler_type : scheduler_types) {
+        if (!Schedulers::known(scheduler_type)) {
+            std::cerr << "Invalid scheduler type: " << scheduler_type << std::endl;
+            return 1;
+        }
+    }
+    bool multi_disk = options.routing.devices > 1;
+    if (multi_disk && (stream || scheduler_types.size() > 1)) {
+        std::cerr << "Several disks need a loaded trace and a single scheduler" << std::endl;
+        return 1;
+    }
+    bool split = options.pieces > 1;
+    if (split && (stream || scheduler_types.size() > 1 || multi_disk || options.telemetry_interval > 0)) {
+        std::cerr << "Splitting needs a loaded trace, a single scheduler and disk and no telemetry" << std::endl;
+        return 1;
+    }
+    if (stream) {
+        if (scheduler_types.size() > 1) {
+            std::cerr << "Can't stream the input through several schedulers" << std::endl;
+            return 1;
+        }
+        if (!Schedulers::run(scheduler_types[0], reader, std::cout, options)) {
+            std::cerr << reader.error() << "";
+            return 1;
+        }
+        return 0;
+    }
+    std::vector<TraceEntry> trace;
+    trace.reserve(reader.size_hint());
+    TraceEntry entry;
+    while (reader.next(entry)) {
+        trace.push_back(entry);
+    }
+    if (reader.failed()) {
+        std::cerr << reader.error() << "";
+        return 1;
+    }
+    if (multi_disk) {
+        return run_multi_disk(scheduler_types[0], trace, threads, options);
+    }
+    if (split) {
+        return run_split(scheduler_types[0], trace, threads, options);
+    }
+    if (scheduler_types.size() > 1) {
+        run_sweep(scheduler_types, trace, options);
+        return 0;
+    }
+    TraceArraySource source(trace);
+    //only a checkpoint that doesn't fit the trace can fail here 
+    if (!Schedulers::run(scheduler_types[0], source, std::cout, options)) 
+    {
+        return 1;
+    }
+    //trivial return statement 
     return 0;
-}
\ No newline at end of file
+}
+//the live mode (-L), simulates the requests of the stream as they come in. memory
+//stays the same however long it runs, the requests in flight and one reorder window
+//of input is all that is kept 
+static int run_live(char scheduler_type, std::istream& in, const SimulationOptions& options) {
+    if (!Schedulers::known(scheduler_type)) {
+        std::cerr << "Invalid scheduler type: " << scheduler_type << std::endl;
+        return 1;
+    }
+    TraceReader reader(in);
+    OutputWriter writer(std::cout, options.quiet);
+    LiveSource source(reader, in, writer, options.reorder_window);
+    SimulationSummary summary;
+    LiveSnapshots snapshots(writer, summary, options.live_interval);
+    bool ok = Schedulers::with_scheduler(scheduler_type, [&](auto& scheduler) {
+        return run_simulation(scheduler, source, writer, summary, options, snapshots);
+    });
+    if (!ok) {
+        writer.flush();
+        std::cerr << source.error() << "";
+        return 1;
+    }
+    write_totals(writer, summary, options);
+    return 0;
+}
+//one (trace, scheduler) simulation of a batch run and the file its output goes to 
+struct BatchJob {
+    std::string trace;
+    char scheduler_type;
+    std::string output;
+};
+//reads a batch manifest, every line is `<tracefile> <schedulers> [name]` and becomes
+//one job per scheduler letter writing to <outdir>/out_<name>_<scheduler> like
+//runit.sh does. without a name its the number at the end of the trace file name
+//(input9 gives out_9_L) or the whole file name if it doesn't end in a number 
+static bool read_manifest(const std::string& manifest, const std::string& output_dir, std::vector<BatchJob>& jobs) {
+    std::ifstream in(manifest);
+    if (!in.is_open()) {
+        std::cerr << "Error opening file: " << manifest << "";
+        return false;
+    }
+    std::string line;
+    std::size_t line_number = 0;
+    while (std::getline(in, line)) {
+        line_number++;
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream iss(line);
+        std::string trace, scheduler_types, name;
+        if (!(iss >> trace >> scheduler_types)) {
+            std::cerr << "Malformed manifest line " << line_number << ": " << line << "";
+            return false;
+        }
+        if (!(iss >> name)) {
+            std::string base = trace.substr(trace.find_last_of('/') + 1);
+            std::size_t digits = base.find_last_not_of("0123456789") + 1;
+            name = digits < base.size() ? base.substr(digits) : base;
+        }
+        if (scheduler_types == "all") scheduler_types = Schedulers::letters();
+        for (char scheduler_type : scheduler_types) {
+            if (!Schedulers::known(scheduler_type)) {
+                std::cerr << "Invalid scheduler type: " << scheduler_type << " in manifest line " << line_number << std::endl;
+                return false;
+            }
+            jobs.push_back({trace, scheduler_type, output_dir + "/out_" + name + "_" + scheduler_type});
+        }
+    }
+    return true;
+}
+//runs one batch job, the trace is streamed straight from its mapping into the output
+//file so many jobs at once don't each hold a whole trace. returns an error message,
+//empty on success 
+static std::string run_job(const BatchJob& job, const SimulationOptions& options) {
+    MappedFile file;
+    if (!file.open(job.trace)) 
+    {
+        return "Error opening file: " + job.trace;
+    }
+    std::ofstream out(job.output);
+    if (!out.is_open()) 
+    {
+        return "Error opening file: " + job.output;
+    }
+    std::string problem;
+    if (is_binary_trace(file)) {
+        BinaryTraceReader reader(file);
+        if (!Schedulers::run(job.scheduler_type, reader, out, options)) problem = reader.error();
+    } else {
+        MappedTraceReader reader(file);
+        if (!Schedulers::run(job.scheduler_type, reader, out, options)) problem = reader.error();
+    }
+    return problem;
+}
+//runs every job of the manifest on the work stealing pool, problems are reported in
+//manifest order once everything is done 
+static int run_batch(const std::string& manifest, const std::string& output_dir, unsigned threads, const SimulationOptions& options) {
+    std::vector<BatchJob> jobs;
+    if (!read_manifest(manifest, output_dir, jobs)) 
+    {
+        return 1;
+    }
+    std::vector<std::string> problems(jobs.size());
+    run_work_stealing(jobs.size(), threads, [&](std::size_t i) {
+        problems[i] = run_job(jobs[i], options);
+    });
+    int status = 0;
+    for (std::size_t i = 0; i < jobs.size(); i++) {
+        if (!problems[i].empty()) {
+            std::cerr << jobs[i].trace << " -s" << jobs[i].scheduler_type << ": " << problems[i] << std::endl;
+            status = 1;
+        }
+    }
+    return status;
+}
+//the benchmarks in bench/ include this file directly and bring their own main
+#ifndef IOSCHED_NO_MAIN
+//the main function that will parse input arguments, read the input file, 
+//and set up our simulation for the scheduler 
+int main(int argc, char* argv[]) {
+    //-l streams the input file through the simulator instead of loading it first 
+    bool stream = false;
+    //-o converts the text input file into the binary trace format instead of simulating 
+    std::string convert_to;
+    //one or more scheduler letters, several (or "all") sweep the trace in parallel 
+    std::string scheduler_types;
+    //-b runs every job of a manifest file on a thread pool, -j sets the number of threads
+    //for that, for the disks of -D and for the pieces of -I 
+    std::string manifest;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    SimulationOptions options;
+    //-R<file> resumes the run a checkpoint was taken of 
+    std::string resume_path;
+    const char* usage = "Usage: ./iosched [-l] [-q] [-p <profile>] [-P<text|json>] [-T<interval>,<file>] [-M<limit>] [-Q<depth>[,sstf|,rpo]] -s<schedulers> <inputfile>\n"
+                        "       ./iosched [-l] [-q] [-C<seconds>,<file>] [-R<file>] [-p <profile>] [-P<text|json>] [-M<limit>] [-Q<depth>[,sstf|,rpo]] -s<scheduler> <inputfile> >> <output>\n"
+                        "       ./iosched [-q] [-j<threads>] -D<disks>[,stripe<width>|,hash|,tag] -s<scheduler> <inputfile>\n"
+                        "       ./iosched [-q] [-j<threads>] -I<pieces> [-p <profile>] [-P<text|json>] [-M<limit>] [-Q<depth>[,sstf|,rpo]] -s<scheduler> <inputfile>\n"
+                        "       ./iosched [-q] -L<interval>[,<window>] [-p <profile>] [-P<text|json>] [-M<limit>] [-Q<depth>[,sstf|,rpo]] -s<scheduler> <inputfile|->\n"
+                        "       ./iosched -o <binaryfile> <inputfile>\n"
+                        "       ./iosched -b <manifest> [-q] [-j<threads>] <outputdir>";
+    int opt;
+    while ((opt = getopt(argc, argv, "lqs:o:b:j:D:p:P:T:M:I:Q:L:C:R:")) != -1) {
+        switch (opt) {
+            case 'q':
+                options.quiet = true;
+                break;
+            case 'l':
+                stream = true;
+                break;
+            case 's':
+                scheduler_types = optarg;
+                if (scheduler_types == "all") scheduler_types = Schedulers::letters();
+                break;
+            case 'o':
+                convert_to = optarg;
+                break;
+            case 'b':
+                manifest = optarg;
+                break;
+            case 'j':
+                threads = static_cast<unsigned>(std::max(1, atoi(optarg)));
+                break;
+            case 'p': {
+                std::string problem = options.model.load(optarg);
+                if (!problem.empty()) {
+                    std::cerr << problem << std::endl;
+                    return 1;
+                }
+                break;
+            }
+            case 'P':
+                if (strcmp(optarg, "text") == 0) options.percentiles = SimulationOptions::PERCENTILES_TEXT;
+                else if (strcmp(optarg, "json") == 0) options.percentiles = SimulationOptions::PERCENTILES_JSON;
+                else {
+                    std::cerr << usage;
+                    return 1;
+                }
+                break;
+            case 'T': {
+                const char* comma = strchr(optarg, ',');
+                options.telemetry_interval = atoll(optarg);
+                if (comma == nullptr || comma[1] == '\0' || options.telemetry_interval < 1) {
+                    std::cerr << "Invalid telemetry: " << optarg << std::endl;
+                    return 1;
+                }
+                options.telemetry_path = comma + 1;
+                break;
+            }
+            case 'M':
+                options.merge_limit = atoi(optarg);
+                break;
+            case 'Q': {
+                const char* comma = strchr(optarg, ',');
+                options.queue_depth = atoi(optarg);
+                if (comma != nullptr && strcmp(comma + 1, "rpo") == 0) options.queue_rotational = true;
+                else if (comma != nullptr && strcmp(comma + 1, "sstf") != 0) options.queue_depth = 0;
+                if (options.queue_depth < 1) {
+                    std::cerr << "Invalid device queue: " << optarg << std::endl;
+                    return 1;
+                }
+                break;
+            }
+            case 'L': {
+                const char* comma = strchr(optarg, ',');
+                options.live = true;
+                options.live_interval = atoll(optarg);
+                if (comma != nullptr) options.reorder_window = atoll(comma + 1);
+                if (options.live_interval < 0 || options.reorder_window < 0) {
+                    std::cerr << "Invalid live mode: " << optarg << std::endl;
+                    return 1;
+                }
+                break;
+            }
+            case 'C': {
+                const char* comma = strchr(optarg, ',');
+                char* end = nullptr;
+                options.checkpoint_seconds = strtod(optarg, &end);
+                if (comma == nullptr || end != comma || comma[1] == '\0' || options.checkpoint_seconds < 0) {
+                    std::cerr << "Invalid checkpoints: " << optarg << std::endl;
+                    return 1;
+                }
+                options.checkpoint_path = comma + 1;
+                break;
+            }
+            case 'R':
+                resume_path = optarg;
+                break;
+            case 'I':
+                options.pieces = atoi(optarg);
+                if (options.pieces < 1) {
+                    std::cerr << "Invalid pieces: " << optarg << std::endl;
+                    return 1;
+                }
+                break;
+            case 'D':
+                if (!options.routing.parse(optarg)) {
+                    std::cerr << "Invalid disk array: " << optarg << std::endl;
+                    return 1;
+                }
+                break;
+            default:
+                std::cerr << usage;
+                return 1;
+        }
+    }
+    //a merged request could be sitting in the device queue already 
+    if (options.queue_depth > 0 && options.merge_limit > 1) {
+        std::cerr << "Merging doesn't work with a device queue" << std::endl;
+        return 1;
+    }
+    //first check if all the necessary arguments are there
+    if ((scheduler_types.empty() && convert_to.empty() && manifest.empty()) || optind >= argc) {
+        std::cerr << usage;
+        return 1;
+    }
+    //in batch mode the remaining argument is the output directory 
+    if (!manifest.empty()) {
+        if (options.telemetry_interval > 0) {
+            std::cerr << "Telemetry can't be recorded in batch mode" << std::endl;
+            return 1;
+        }
+        if (options.pieces > 1 || options.live || !options.checkpoint_path.empty() || !resume_path.empty()) {
+            std::cerr << "Batch mode can't split traces, run live or take checkpoints" << std::endl;
+            return 1;
+        }
+        return run_batch(manifest, argv[optind], threads, options);
+    }
+    if (scheduler_types.empty() && convert_to.empty()) {
+        std::cerr << usage;
+        return 1;
+    }
+    //a checkpoint is the state of one simulation loop, which is what the other modes run
+    //several of or, with telemetry, keep more state around 
+    if ((!options.checkpoint_path.empty() || !resume_path.empty()) && convert_to.empty()) {
+        if (scheduler_types.size() != 1 || options.routing.devices > 1 || options.pieces > 1 || options.live || options.telemetry_interval > 0) {
+            std::cerr << "Checkpoints need a single scheduler and disk, no splitting, no live mode and no telemetry" << std::endl;
+            return 1;
+        }
+    }
+    //the resumed run writes the output from where the checkpoint saw it end. if that is
+    //a file, anything the interrupted run wrote after the checkpoint is cut off so the
+    //file ends up as if the run never stopped. anything else just gets the rest 
+    if (!resume_path.empty() && convert_to.empty()) {
+        long long offset = 0;
+        std::string problem = load_checkpoint(resume_path, scheduler_types[0], options, offset);
+        if (!problem.empty()) {
+            std::cerr << problem << std::endl;
+            return 1;
+        }
+        struct stat output;
+        if (fstat(STDOUT_FILENO, &output) == 0 && S_ISREG(output.st_mode)) {
+            if (output.st_size < offset) {
+                std::cerr << "Output is shorter than checkpoint " << resume_path << " expects, append to the output of the interrupted run" << std::endl;
+                return 1;
+            }
+            if (ftruncate(STDOUT_FILENO, static_cast<off_t>(offset)) != 0 || lseek(STDOUT_FILENO, static_cast<off_t>(offset), SEEK_SET) < 0) {
+                std::cerr << "Can't cut the output back to checkpoint " << resume_path << std::endl;
+                return 1;
+            }
+        }
+    }
+    //- is the standard input 
+    std::string input_file = argv[optind];
+    if (options.live) {
+        if (scheduler_types.size() != 1 || options.routing.devices > 1 || options.pieces > 1 || options.telemetry_interval > 0) {
+            std::cerr << "Live mode needs a single scheduler and disk, no splitting and no telemetry" << std::endl;
+            return 1;
+        }
+        //so the input knows how much it has buffered 
+        std::ios::sync_with_stdio(false);
+        if (input_file == "-") 
+        {
+            return run_live(scheduler_types[0], std::cin, options);
+        }
+        std::ifstream in(input_file);
+        if (!in.is_open()) {
+            std::cerr << "Error opening file: " << input_file << "";
+            return 1;
+        }
+        return run_live(scheduler_types[0], in, options);
+    }
+    //memory map the input file, if it can't be mapped (like a pipe) fall back to
+    //reading it as a stream 
+    MappedFile mapped;
+    if (mapped.open(input_file)) {
+        if (!convert_to.empty()) {
+            if (is_binary_trace(mapped)) {
+                std::cerr << "Already a binary trace: " << input_file << "";
+                return 1;
+            }
+            std::string problem = convert_trace(mapped, convert_to);
+            if (!problem.empty()) {
+                std::cerr << problem << "";
+                return 1;
+            }
+            return 0;
+        }
+        //binary traces are recognized by their magic, anything else is text 
+        if (is_binary_trace(mapped)) {
+            BinaryTraceReader reader(mapped);
+            return run_trace(scheduler_types, reader, stream, threads, options);
+        }
+        MappedTraceReader reader(mapped);
+        return run_trace(scheduler_types, reader, stream, threads, options);
+    }
+    if (!convert_to.empty()) {
+        std::cerr << "Can only convert a regular file: " << input_file << "";
+        return 1;
+    }
+    //essentially read the input file pretty trivial with necessary
+    //input parsing 
+    std::ifstream infile;
+    if (input_file != "-") infile.open(input_file);
+    //checking if we can open file 
+    if (input_file != "-" && !infile.is_open()) {
+        std::cerr << "Error opening file: " << input_file << "";
+        return 1;
+    }
+    TraceReader reader(input_file == "-" ? std::cin : infile);
+    return run_trace(scheduler_types, reader, stream, threads, options);
+}
+#endif
@@ -0,0 +1,19 @@
+# rough 7200 rpm desktop drive in simulator time units of 0.1 ms, tracks are
+# cylinders. short seeks follow the square root, long ones grow linearly
+seek curve
+short_base 3
+short_sqrt 0.9
+long_base 60
+long_track 0.0016
+boundary 5000
+# head settle after every seek that moves the head
+settle 10
+# 8.33 ms per revolution with 400 sectors a track
+rotation 83
+sectors 400
+# 512 byte sectors at about 100 MB/s
+transfer 0.05
+# SSTF picks by positioning time (shortest access time first)
+rank cost
+# how many of the requests nearest to the head it compares
+rank_window 64